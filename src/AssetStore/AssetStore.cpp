@@ -1,8 +1,16 @@
+#include <fstream>
+#include <sstream>
+#include <algorithm>
 #include <SDL2/SDL_image.h>
 #include "AssetStore.h"
+#include "SkylinePacker.h"
 #include "../Logger/Logger.h"
 
 AssetStore::AssetStore() {
+	renderer = nullptr;
+	textBytes = 0;
+	textBudget = DEFAULT_TEXT_CACHE_BUDGET;
+	nextTextHandle = 1;
 	Logger::Info("AssetStore constructor called.");
 }
 
@@ -12,11 +20,25 @@ AssetStore::~AssetStore() {
 }
 
 void AssetStore::ClearAssets() {
-	for (auto texture: textures) {
-		SDL_DestroyTexture(texture.second);
+	for (auto texture: ownedTextures) {
+		SDL_DestroyTexture(texture);
 	}
+	ownedTextures.clear();
 	textures.clear();
 
+	for (auto surface: pendingSurfaces) {
+		SDL_FreeSurface(surface.second);
+	}
+	pendingSurfaces.clear();
+
+	for (auto &text: textTextures) {
+		SDL_DestroyTexture(text.second.texture);
+	}
+	textTextures.clear();
+	textLru.clear();
+	textBytes = 0;
+
+	glyphAtlases.clear();
 	for (auto font: fonts) {
 		TTF_CloseFont(font.second);
 	}
@@ -24,20 +46,243 @@ void AssetStore::ClearAssets() {
 }
 
 void AssetStore::AddTexture(SDL_Renderer* renderer, const std::string &assetId, const std::string &filePath) {
+	this->renderer = renderer;
+	if (textures.find(assetId) != textures.end() || pendingSurfaces.find(assetId) != pendingSurfaces.end()) {
+		return;
+	}
+
 	SDL_Surface* surface = IMG_Load(filePath.c_str());
-	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-	SDL_FreeSurface(surface);
-	textures.emplace(assetId, texture);
+	if (!surface) {
+		Logger::Err("error loading texture " + filePath + ": " + IMG_GetError());
+		return;
+	}
+	pendingSurfaces.emplace(assetId, surface);
 }
 
-SDL_Texture *AssetStore::GetTexture(const std::string &assetId) {
-	return textures[assetId];
+SDL_Texture *AssetStore::GetTexture(const std::string &assetId) const {
+	const TextureRegion *region = GetTextureRegion(assetId);
+	return region ? region->texture : nullptr;
 }
 
-void AssetStore::AddFont(const std::string &assetId, const std::string &filePath, int fontSize) {
-	fonts.emplace(assetId, TTF_OpenFont(filePath.c_str(), fontSize));
+const TextureRegion *AssetStore::GetTextureRegion(const std::string &assetId) const {
+	auto texture = textures.find(assetId);
+	return texture != textures.end() ? &texture->second : nullptr;
+}
+
+int AssetStore::atlasPageSize() const {
+	SDL_RendererInfo info;
+	if (renderer && SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0 && info.max_texture_height > 0) {
+		return std::min(MAX_ATLAS_PAGE_SIZE, std::min(info.max_texture_width, info.max_texture_height));
+	}
+	return MAX_ATLAS_PAGE_SIZE;
+}
+
+void AssetStore::BuildAtlas(const std::string &savePath) {
+	if (pendingSurfaces.empty()) {
+		return;
+	}
+
+	// Packing the tallest images first leaves a flatter skyline and fewer pages.
+	std::vector<std::pair<std::string, SDL_Surface*>> surfaces(pendingSurfaces.begin(), pendingSurfaces.end());
+	pendingSurfaces.clear();
+	std::stable_sort(surfaces.begin(), surfaces.end(), [](const auto &a, const auto &b) {
+		return a.second->h != b.second->h ? a.second->h > b.second->h : a.second->w > b.second->w;
+	});
+
+	const int pageSize = atlasPageSize();
+	std::vector<SkylinePacker> packers;
+	std::vector<SDL_Surface*> pages;
+	std::vector<std::pair<std::string, std::pair<size_t, SDL_Rect>>> packed;
+
+	for (auto &surface: surfaces) {
+		const int width = surface.second->w + ATLAS_PADDING;
+		const int height = surface.second->h + ATLAS_PADDING;
+		if (width > pageSize || height > pageSize) {
+			SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface.second);
+			ownedTextures.push_back(texture);
+			textures[surface.first] = {texture, {0, 0, surface.second->w, surface.second->h}, surface.second->w, surface.second->h};
+			SDL_FreeSurface(surface.second);
+			continue;
+		}
+
+		SDL_Point position;
+		size_t page = 0;
+		while (page < packers.size() && !packers[page].Insert(width, height, position)) {
+			page++;
+		}
+		if (page == packers.size()) {
+			packers.emplace_back(pageSize, pageSize);
+			pages.push_back(SDL_CreateRGBSurfaceWithFormat(0, pageSize, pageSize, 32, SDL_PIXELFORMAT_RGBA32));
+			packers.back().Insert(width, height, position);
+		}
+
+		SDL_Rect rect = {position.x, position.y, surface.second->w, surface.second->h};
+		SDL_SetSurfaceBlendMode(surface.second, SDL_BLENDMODE_NONE);
+		SDL_BlitSurface(surface.second, NULL, pages[page], &rect);
+		rect.w = surface.second->w;
+		rect.h = surface.second->h;
+		SDL_FreeSurface(surface.second);
+		packed.push_back({surface.first, {page, rect}});
+	}
+
+	std::vector<SDL_Texture*> pageTextures;
+	for (auto page: pages) {
+		pageTextures.push_back(SDL_CreateTextureFromSurface(renderer, page));
+		ownedTextures.push_back(pageTextures.back());
+	}
+	for (auto &region: packed) {
+		textures[region.first] = {pageTextures[region.second.first], region.second.second, pageSize, pageSize};
+	}
+	Logger::Info("packed " + std::to_string(packed.size()) + " textures into " + std::to_string(pages.size()) + " atlas pages");
+
+	if (!savePath.empty()) {
+		std::ofstream metadata(savePath + ".atlas");
+		for (size_t i = 0; i < pages.size(); i++) {
+			const std::string pagePath = savePath + "-" + std::to_string(i) + ".png";
+			if (IMG_SavePNG(pages[i], pagePath.c_str()) != 0) {
+				Logger::Err("error saving atlas page " + pagePath);
+			}
+			metadata << "page " << i << " " << pagePath << "\n";
+		}
+		for (auto &region: packed) {
+			const SDL_Rect &rect = region.second.second;
+			metadata << "region " << region.first << " " << region.second.first << " " << rect.x << " " << rect.y << " " << rect.w << " " << rect.h << "\n";
+		}
+		Logger::Info("saved texture atlas to " + savePath + ".atlas");
+	}
+
+	for (auto page: pages) {
+		SDL_FreeSurface(page);
+	}
+}
+
+bool AssetStore::LoadAtlas(SDL_Renderer* renderer, const std::string &savePath) {
+	this->renderer = renderer;
+	std::ifstream metadata(savePath + ".atlas");
+	if (!metadata) {
+		Logger::Err("error opening texture atlas " + savePath + ".atlas");
+		return false;
+	}
+
+	std::vector<SDL_Texture*> pageTextures;
+	std::vector<SDL_Point> pageSizes;
+	std::string line;
+	while (std::getline(metadata, line)) {
+		std::istringstream fields(line);
+		std::string type;
+		fields >> type;
+
+		if (type == "page") {
+			size_t page;
+			std::string pagePath;
+			fields >> page >> pagePath;
+			SDL_Surface *surface = IMG_Load(pagePath.c_str());
+			if (!surface || page != pageTextures.size()) {
+				Logger::Err("error loading atlas page " + pagePath);
+				if (surface) {
+					SDL_FreeSurface(surface);
+				}
+				return false;
+			}
+			pageTextures.push_back(SDL_CreateTextureFromSurface(renderer, surface));
+			pageSizes.push_back({surface->w, surface->h});
+			ownedTextures.push_back(pageTextures.back());
+			SDL_FreeSurface(surface);
+		} else if (type == "region") {
+			std::string assetId;
+			size_t page;
+			SDL_Rect rect;
+			fields >> assetId >> page >> rect.x >> rect.y >> rect.w >> rect.h;
+			if (!fields || page >= pageTextures.size()) {
+				Logger::Err("bad region in texture atlas " + savePath + ".atlas: " + line);
+				continue;
+			}
+			textures[assetId] = {pageTextures[page], rect, pageSizes[page].x, pageSizes[page].y};
+		}
+	}
+
+	Logger::Info("loaded texture atlas " + savePath + ".atlas");
+	return true;
+}
+
+void AssetStore::AddFont(SDL_Renderer* renderer, const std::string &assetId, const std::string &filePath, int fontSize) {
+	TTF_Font *font = TTF_OpenFont(filePath.c_str(), fontSize);
+	if (!font) {
+		Logger::Err("error loading font " + filePath);
+	}
+	fonts.emplace(assetId, font);
+	glyphAtlases.emplace(assetId, std::make_unique<GlyphAtlas>(renderer, font));
 }
 
 TTF_Font *AssetStore::GetFont(const std::string &assetId) {
 	return fonts[assetId];
 }
+
+GlyphAtlas *AssetStore::GetGlyphAtlas(const std::string &assetId) {
+	auto glyphAtlas = glyphAtlases.find(assetId);
+	return glyphAtlas != glyphAtlases.end() ? glyphAtlas->second.get() : nullptr;
+}
+
+size_t AssetStore::AddTextTexture(SDL_Renderer* renderer, const std::string &fontId, const std::string &text, SDL_Color color, int &width, int &height) {
+	width = 0;
+	height = 0;
+	TTF_Font *font = GetFont(fontId);
+	if (!font) {
+		return 0;
+	}
+	SDL_Surface *surface = TTF_RenderText_Blended(font, text.c_str(), color);
+	if (!surface) {
+		return 0;
+	}
+	SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+	width = surface->w;
+	height = surface->h;
+	SDL_FreeSurface(surface);
+	if (!texture) {
+		return 0;
+	}
+
+	const size_t handle = nextTextHandle++;
+	const size_t bytes = static_cast<size_t>(width) * height * 4;
+	textLru.push_front(handle);
+	textTextures[handle] = {texture, bytes, textLru.begin()};
+	textBytes += bytes;
+	evictTextTextures();
+	return handle;
+}
+
+SDL_Texture *AssetStore::GetTextTexture(size_t handle) {
+	auto text = textTextures.find(handle);
+	if (text == textTextures.end()) {
+		return nullptr;
+	}
+	textLru.splice(textLru.begin(), textLru, text->second.lruPosition);
+	return text->second.texture;
+}
+
+void AssetStore::RemoveTextTexture(size_t handle) {
+	auto text = textTextures.find(handle);
+	if (text == textTextures.end()) {
+		return;
+	}
+	SDL_DestroyTexture(text->second.texture);
+	textBytes -= text->second.bytes;
+	textLru.erase(text->second.lruPosition);
+	textTextures.erase(text);
+}
+
+void AssetStore::SetTextCacheBudget(size_t bytes) {
+	textBudget = bytes;
+	evictTextTextures();
+}
+
+size_t AssetStore::GetTextCacheBytes() const {
+	return textBytes;
+}
+
+// The most recently used texture is always kept, even if it's larger than the whole budget.
+void AssetStore::evictTextTextures() {
+	while (textBytes > textBudget && textLru.size() > 1) {
+		RemoveTextTexture(textLru.back());
+	}
+}
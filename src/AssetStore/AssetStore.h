@@ -2,26 +2,87 @@
 #define ASSETSTORE_H
 
 #include <map>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <vector>
 #include <string>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include "GlyphAtlas.h"
+
+// Where a texture asset ended up: either a region of an atlas page or the whole of its own texture. The size of
+// the whole texture is kept with it, so texture coordinates can be worked out without asking the renderer.
+struct TextureRegion {
+	SDL_Texture *texture;
+	SDL_Rect rect;
+	int textureWidth;
+	int textureHeight;
+};
 
 class AssetStore {
 private:
-	std::map<std::string, SDL_Texture*> textures;
+	static const size_t DEFAULT_TEXT_CACHE_BUDGET = 16 * 1024 * 1024;
+
+	struct CachedText {
+		SDL_Texture *texture;
+		size_t bytes;
+		std::list<size_t>::iterator lruPosition;
+	};
+
+	SDL_Renderer *renderer;
+	std::map<std::string, TextureRegion> textures;
+	std::map<std::string, SDL_Surface*> pendingSurfaces;
+	std::vector<SDL_Texture*> ownedTextures;
 	std::map<std::string, TTF_Font*> fonts;
+	std::map<std::string, std::unique_ptr<GlyphAtlas>> glyphAtlases;
+
+	std::unordered_map<size_t, CachedText> textTextures;
+	std::list<size_t> textLru;
+	size_t textBytes;
+	size_t textBudget;
+	size_t nextTextHandle;
 	// std::map<std::string, SDL_Texture*> audio;
 
+	int atlasPageSize() const;
+	void evictTextTextures();
+
 public:
+	// Atlas pages are at most this size, smaller if the renderer can't take textures that big. Each image is packed
+	// with this many pixels of space to its right and below it, so filtering doesn't bleed in its neighbours.
+	static constexpr int MAX_ATLAS_PAGE_SIZE = 2048;
+	static constexpr int ATLAS_PADDING = 2;
+
 	AssetStore();
 	~AssetStore();
 
 	void ClearAssets();
 	void AddTexture(SDL_Renderer* renderer, const std::string &assetId, const std::string &filePath);
-	SDL_Texture *GetTexture(const std::string &assetId);
+	// Lookups don't call into SDL, so they're safe from the simulation thread as long as nothing is being added.
+	// Textures only become available once BuildAtlas has run.
+	SDL_Texture *GetTexture(const std::string &assetId) const;
+	const TextureRegion *GetTextureRegion(const std::string &assetId) const;
 
-	void AddFont(const std::string &assetId, const std::string &filePath, int fontSize);
+	// Textures added since the last build are packed into atlas pages, so sprites from different images can be
+	// drawn in one batch. Creates textures, so it must run on the thread that owns the renderer. Textures too big for a page keep a texture of their own. When savePath is set the pages
+	// are also written as <savePath>-<page>.png along with a <savePath>.atlas file listing the regions.
+	void BuildAtlas(const std::string &savePath = "");
+	// Loads an atlas written by BuildAtlas; textures it contains aren't loaded again by AddTexture.
+	bool LoadAtlas(SDL_Renderer* renderer, const std::string &savePath);
+
+	// Fonts get a glyph atlas as they're added, for drawing text without rasterizing it every frame.
+	void AddFont(SDL_Renderer* renderer, const std::string &assetId, const std::string &filePath, int fontSize);
 	TTF_Font *GetFont(const std::string &assetId);
+	GlyphAtlas *GetGlyphAtlas(const std::string &assetId);
+
+	// Text rendered into textures, for labels too large to draw as glyph quads. Once the textures take more than
+	// the budget the least recently used ones are destroyed, so a handle can stop being valid at any time and
+	// GetTextTexture then returns nullptr. Handles are never 0.
+	size_t AddTextTexture(SDL_Renderer* renderer, const std::string &fontId, const std::string &text, SDL_Color color, int &width, int &height);
+	SDL_Texture *GetTextTexture(size_t handle);
+	void RemoveTextTexture(size_t handle);
+	void SetTextCacheBudget(size_t bytes);
+	size_t GetTextCacheBytes() const;
 };
 
 #endif // ASSETSTORE_H
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include "GlyphAtlas.h"
+#include "SkylinePacker.h"
+#include "../Logger/Logger.h"
+
+GlyphAtlas::GlyphAtlas(SDL_Renderer *renderer, TTF_Font *font) {
+	this->font = font;
+	texture = nullptr;
+	lineHeight = font ? TTF_FontHeight(font) : 0;
+	for (auto &glyph: glyphs) {
+		glyph = {{0, 0, 0, 0}, 0, 0};
+	}
+	if (!font) {
+		return;
+	}
+
+	// TTF_RenderGlyph_Blended renders a glyph the way it would appear in a string: a cell as tall as the line,
+	// with the glyph sitting on the baseline, so laying out the cells by advance reproduces TTF_RenderText.
+	const SDL_Color white = {255, 255, 255, 255};
+	std::vector<SDL_Surface*> surfaces;
+	for (Uint16 ch = FIRST_GLYPH; ch <= LAST_GLYPH; ch++) {
+		Glyph &glyph = glyphs[ch - FIRST_GLYPH];
+		int minX, maxX, minY, maxY;
+		if (TTF_GlyphMetrics(font, ch, &minX, &maxX, &minY, &maxY, &glyph.advance) != 0) {
+			surfaces.push_back(nullptr);
+			continue;
+		}
+		glyph.offsetX = std::min(minX, 0);
+		surfaces.push_back(ch == ' ' ? nullptr : TTF_RenderGlyph_Blended(font, ch, white));
+	}
+
+	std::vector<SDL_Point> positions;
+	int pageSize = 128;
+	while (!pack(surfaces, pageSize, positions) && pageSize < MAX_PAGE_SIZE) {
+		pageSize *= 2;
+	}
+
+	SDL_Surface *page = SDL_CreateRGBSurfaceWithFormat(0, pageSize, pageSize, 32, SDL_PIXELFORMAT_RGBA32);
+	for (size_t i = 0; i < surfaces.size(); i++) {
+		if (!surfaces[i]) {
+			continue;
+		}
+		if (i < positions.size()) {
+			SDL_Rect rect = {positions[i].x, positions[i].y, surfaces[i]->w, surfaces[i]->h};
+			SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(surfaces[i], NULL, page, &rect);
+			glyphs[i].srcRect = {positions[i].x, positions[i].y, surfaces[i]->w, surfaces[i]->h};
+		}
+		SDL_FreeSurface(surfaces[i]);
+	}
+
+	texture = SDL_CreateTextureFromSurface(renderer, page);
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	SDL_FreeSurface(page);
+}
+
+GlyphAtlas::~GlyphAtlas() {
+	if (texture) {
+		SDL_DestroyTexture(texture);
+	}
+}
+
+bool GlyphAtlas::pack(const std::vector<SDL_Surface*> &surfaces, int pageSize, std::vector<SDL_Point> &positions) const {
+	SkylinePacker packer(pageSize, pageSize);
+	positions.assign(surfaces.size(), {0, 0});
+	for (size_t i = 0; i < surfaces.size(); i++) {
+		if (surfaces[i] && !packer.Insert(surfaces[i]->w + PADDING, surfaces[i]->h + PADDING, positions[i])) {
+			Logger::Info("glyph atlas doesn't fit in " + std::to_string(pageSize) + "px");
+			positions.resize(i);
+			return false;
+		}
+	}
+	return true;
+}
+
+SDL_Texture *GlyphAtlas::GetTexture() const {
+	return texture;
+}
+
+int GlyphAtlas::GetLineHeight() const {
+	return lineHeight;
+}
+
+const TextLayout &GlyphAtlas::Layout(const std::string &text) {
+	auto cached = layouts.find(text);
+	if (cached != layouts.end()) {
+		return cached->second;
+	}
+	if (layouts.size() >= MAX_CACHED_LAYOUTS) {
+		layouts.clear();
+	}
+
+	TextLayout &layout = layouts[text];
+	layout.height = lineHeight;
+	int x = 0;
+	Uint16 previous = 0;
+	for (unsigned char c: text) {
+		const Uint16 ch = c >= FIRST_GLYPH && c <= LAST_GLYPH ? c : '?';
+		const Glyph &glyph = glyphs[ch - FIRST_GLYPH];
+		if (previous && font) {
+			x += TTF_GetFontKerningSizeGlyphs(font, previous, ch);
+		}
+		if (glyph.srcRect.w > 0) {
+			const SDL_FRect dstRect = {
+				static_cast<float>(x + glyph.offsetX),
+				0.0f,
+				static_cast<float>(glyph.srcRect.w),
+				static_cast<float>(glyph.srcRect.h)
+			};
+			layout.quads.push_back({glyph.srcRect, dstRect});
+		}
+		x += glyph.advance;
+		previous = ch;
+	}
+	layout.width = x;
+	return layout;
+}
@@ -0,0 +1,59 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+struct GlyphQuad {
+	SDL_Rect srcRect;
+	SDL_FRect dstRect;
+};
+
+// Glyph quads of a string relative to its top left corner.
+struct TextLayout {
+	std::vector<GlyphQuad> quads;
+	int width;
+	int height;
+};
+
+// The printable ASCII glyphs of a font rasterized once, in white, into a single texture. Strings are laid out
+// from the glyph metrics with kerning, and the layouts are cached by string since most labels don't change.
+// Other characters are drawn as '?'.
+class GlyphAtlas {
+private:
+	static constexpr Uint16 FIRST_GLYPH = 32;
+	static constexpr Uint16 LAST_GLYPH = 126;
+	static constexpr int PADDING = 1;
+	static constexpr int MAX_PAGE_SIZE = 2048;
+	static const size_t MAX_CACHED_LAYOUTS = 1024;
+
+	struct Glyph {
+		SDL_Rect srcRect;
+		int offsetX;
+		int advance;
+	};
+
+	TTF_Font *font;
+	SDL_Texture *texture;
+	int lineHeight;
+	Glyph glyphs[LAST_GLYPH - FIRST_GLYPH + 1];
+	std::unordered_map<std::string, TextLayout> layouts;
+
+	bool pack(const std::vector<SDL_Surface*> &surfaces, int pageSize, std::vector<SDL_Point> &positions) const;
+
+public:
+	GlyphAtlas(SDL_Renderer *renderer, TTF_Font *font);
+	~GlyphAtlas();
+
+	GlyphAtlas(const GlyphAtlas&) = delete;
+	GlyphAtlas &operator =(const GlyphAtlas&) = delete;
+
+	SDL_Texture *GetTexture() const;
+	int GetLineHeight() const;
+	const TextLayout &Layout(const std::string &text);
+};
+
+#endif // GLYPH_ATLAS_H
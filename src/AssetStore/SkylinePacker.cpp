@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <climits>
+#include "SkylinePacker.h"
+
+SkylinePacker::SkylinePacker(int width, int height): width(width), height(height) {
+	skyline.push_back({0, 0, width});
+}
+
+// Finds how high a rectangle starting at the segment would have to sit to clear every segment it spans.
+bool SkylinePacker::fits(size_t segmentIdx, int rectWidth, int rectHeight, int &y) const {
+	const int x = skyline[segmentIdx].x;
+	if (x + rectWidth > width) {
+		return false;
+	}
+
+	y = 0;
+	int widthLeft = rectWidth;
+	for (size_t i = segmentIdx; widthLeft > 0; i++) {
+		y = std::max(y, skyline[i].y);
+		if (y + rectHeight > height) {
+			return false;
+		}
+		widthLeft -= skyline[i].width;
+	}
+	return true;
+}
+
+void SkylinePacker::place(size_t segmentIdx, int x, int y, int rectWidth, int rectHeight) {
+	skyline.insert(skyline.begin() + segmentIdx, {x, y + rectHeight, rectWidth});
+
+	// Trim or drop the segments now covered by the new one.
+	const int right = x + rectWidth;
+	size_t i = segmentIdx + 1;
+	while (i < skyline.size() && skyline[i].x < right) {
+		const int shrink = right - skyline[i].x;
+		if (shrink >= skyline[i].width) {
+			skyline.erase(skyline.begin() + i);
+			continue;
+		}
+		skyline[i].x += shrink;
+		skyline[i].width -= shrink;
+		break;
+	}
+
+	for (size_t j = 0; j + 1 < skyline.size();) {
+		if (skyline[j].y == skyline[j + 1].y) {
+			skyline[j].width += skyline[j + 1].width;
+			skyline.erase(skyline.begin() + j + 1);
+		} else {
+			j++;
+		}
+	}
+}
+
+bool SkylinePacker::Insert(int rectWidth, int rectHeight, SDL_Point &position) {
+	int bestTop = INT_MAX;
+	int bestX = INT_MAX;
+	size_t bestSegment = skyline.size();
+	int bestY = 0;
+
+	for (size_t i = 0; i < skyline.size(); i++) {
+		int y;
+		if (!fits(i, rectWidth, rectHeight, y)) {
+			continue;
+		}
+		const int top = y + rectHeight;
+		if (top < bestTop || (top == bestTop && skyline[i].x < bestX)) {
+			bestTop = top;
+			bestX = skyline[i].x;
+			bestSegment = i;
+			bestY = y;
+		}
+	}
+
+	if (bestSegment == skyline.size()) {
+		return false;
+	}
+
+	position = {bestX, bestY};
+	place(bestSegment, bestX, bestY, rectWidth, rectHeight);
+	return true;
+}
@@ -0,0 +1,31 @@
+#ifndef SKYLINE_PACKER_H
+#define SKYLINE_PACKER_H
+
+#include <vector>
+#include <cstddef>
+#include <SDL2/SDL.h>
+
+// Packs rectangles into a fixed size page using the skyline bottom-left heuristic: the page keeps track of the
+// top edge of everything packed so far, and each rectangle goes where that edge is lowest, then leftmost.
+class SkylinePacker {
+private:
+	struct Segment {
+		int x;
+		int y;
+		int width;
+	};
+
+	int width;
+	int height;
+	std::vector<Segment> skyline;
+
+	bool fits(size_t segmentIdx, int rectWidth, int rectHeight, int &y) const;
+	void place(size_t segmentIdx, int x, int y, int rectWidth, int rectHeight);
+
+public:
+	SkylinePacker(int width, int height);
+
+	bool Insert(int rectWidth, int rectHeight, SDL_Point &position);
+};
+
+#endif // SKYLINE_PACKER_H
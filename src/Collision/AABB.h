@@ -0,0 +1,62 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <vector>
+#include "../Components/TransformComponent.h"
+#include "../Components/BoxColliderComponent.h"
+
+struct AABB {
+	float minX;
+	float minY;
+	float maxX;
+	float maxY;
+};
+
+// Structure-of-arrays storage so the narrowphase kernels can load 4/8 boxes at a time.
+struct AABBArray {
+	std::vector<float> minX;
+	std::vector<float> minY;
+	std::vector<float> maxX;
+	std::vector<float> maxY;
+
+	size_t Size() const {
+		return minX.size();
+	}
+
+	void Clear() {
+		minX.clear();
+		minY.clear();
+		maxX.clear();
+		maxY.clear();
+	}
+
+	void Add(const AABB &box) {
+		minX.push_back(box.minX);
+		minY.push_back(box.minY);
+		maxX.push_back(box.maxX);
+		maxY.push_back(box.maxY);
+	}
+
+	AABB Get(size_t idx) const {
+		return {minX[idx], minY[idx], maxX[idx], maxY[idx]};
+	}
+};
+
+inline bool AABBOverlaps(const AABB &a, const AABB &b) {
+	return a.minX < b.maxX
+		&& a.maxX > b.minX
+		&& a.minY < b.maxY
+		&& a.maxY > b.minY;
+}
+
+// Matches what RenderColliderSystem draws: the offset is applied unscaled, the extents are scaled.
+inline AABB GetColliderBounds(const TransformComponent &transform, const BoxColliderComponent &collider) {
+	AABB box;
+	box.minX = transform.position.x + collider.offset.x;
+	box.minY = transform.position.y + collider.offset.y;
+	box.maxX = box.minX + collider.width * transform.scale.x;
+	box.maxY = box.minY + collider.height * transform.scale.y;
+	return box;
+}
+
+#endif // AABB_H
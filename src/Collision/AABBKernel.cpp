@@ -0,0 +1,158 @@
+#include <algorithm>
+#include "AABBKernel.h"
+
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AABB_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+static uint8_t overlapMaskScalar(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count) {
+	uint8_t mask = 0;
+	for (size_t i = 0; i < count; i++) {
+		bool isOverlapping = box.minX < maxX[i]
+			&& box.maxX > minX[i]
+			&& box.minY < maxY[i]
+			&& box.maxY > minY[i];
+		mask |= static_cast<uint8_t>(isOverlapping) << i;
+	}
+	return mask;
+}
+
+void OverlapBatchScalar(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count, uint8_t *hitMasks) {
+	for (size_t base = 0; base < count; base += 8) {
+		size_t n = count - base < 8 ? count - base : 8;
+		hitMasks[base / 8] = overlapMaskScalar(box, minX + base, minY + base, maxX + base, maxY + base, n);
+	}
+}
+
+#ifdef AABB_KERNEL_X86
+
+void OverlapBatchSSE2(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count, uint8_t *hitMasks) {
+	const __m128 boxMinX = _mm_set1_ps(box.minX);
+	const __m128 boxMinY = _mm_set1_ps(box.minY);
+	const __m128 boxMaxX = _mm_set1_ps(box.maxX);
+	const __m128 boxMaxY = _mm_set1_ps(box.maxY);
+
+	size_t base = 0;
+	for (; base + 8 <= count; base += 8) {
+		int mask = 0;
+		for (size_t half = 0; half < 8; half += 4) {
+			const size_t i = base + half;
+			__m128 hit = _mm_and_ps(
+				_mm_and_ps(_mm_cmplt_ps(boxMinX, _mm_loadu_ps(maxX + i)), _mm_cmpgt_ps(boxMaxX, _mm_loadu_ps(minX + i))),
+				_mm_and_ps(_mm_cmplt_ps(boxMinY, _mm_loadu_ps(maxY + i)), _mm_cmpgt_ps(boxMaxY, _mm_loadu_ps(minY + i)))
+			);
+			mask |= _mm_movemask_ps(hit) << half;
+		}
+		hitMasks[base / 8] = static_cast<uint8_t>(mask);
+	}
+
+	if (base < count) {
+		hitMasks[base / 8] = overlapMaskScalar(box, minX + base, minY + base, maxX + base, maxY + base, count - base);
+	}
+}
+
+__attribute__((target("avx2")))
+void OverlapBatchAVX2(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count, uint8_t *hitMasks) {
+	const __m256 boxMinX = _mm256_set1_ps(box.minX);
+	const __m256 boxMinY = _mm256_set1_ps(box.minY);
+	const __m256 boxMaxX = _mm256_set1_ps(box.maxX);
+	const __m256 boxMaxY = _mm256_set1_ps(box.maxY);
+
+	size_t base = 0;
+	for (; base + 8 <= count; base += 8) {
+		__m256 hit = _mm256_and_ps(
+			_mm256_and_ps(
+				_mm256_cmp_ps(boxMinX, _mm256_loadu_ps(maxX + base), _CMP_LT_OQ),
+				_mm256_cmp_ps(boxMaxX, _mm256_loadu_ps(minX + base), _CMP_GT_OQ)
+			),
+			_mm256_and_ps(
+				_mm256_cmp_ps(boxMinY, _mm256_loadu_ps(maxY + base), _CMP_LT_OQ),
+				_mm256_cmp_ps(boxMaxY, _mm256_loadu_ps(minY + base), _CMP_GT_OQ)
+			)
+		);
+		hitMasks[base / 8] = static_cast<uint8_t>(_mm256_movemask_ps(hit));
+	}
+
+	// The tail runs non-VEX code, which stalls on the AVX to SSE transition unless the upper halves are cleared.
+	_mm256_zeroupper();
+	if (base < count) {
+		hitMasks[base / 8] = overlapMaskScalar(box, minX + base, minY + base, maxX + base, maxY + base, count - base);
+	}
+}
+
+#else
+
+void OverlapBatchSSE2(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count, uint8_t *hitMasks) {
+	OverlapBatchScalar(box, minX, minY, maxX, maxY, count, hitMasks);
+}
+
+void OverlapBatchAVX2(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count, uint8_t *hitMasks) {
+	OverlapBatchScalar(box, minX, minY, maxX, maxY, count, hitMasks);
+}
+
+#endif
+
+typedef void (*OverlapBatchFunc)(const AABB&, const float*, const float*, const float*, const float*, size_t, uint8_t*);
+
+struct OverlapBatchKernel {
+	OverlapBatchFunc func;
+	const char *name;
+};
+
+static OverlapBatchKernel selectKernel() {
+#ifdef AABB_KERNEL_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return {OverlapBatchAVX2, "avx2"};
+	}
+	return {OverlapBatchSSE2, "sse2"};
+#else
+	return {OverlapBatchScalar, "scalar"};
+#endif
+}
+
+static const OverlapBatchKernel &getKernel() {
+	static const OverlapBatchKernel kernel = selectKernel();
+	return kernel;
+}
+
+void OverlapBatch(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count, uint8_t *hitMasks) {
+	getKernel().func(box, minX, minY, maxX, maxY, count, hitMasks);
+}
+
+const char *OverlapBatchKernelName() {
+	return getKernel().name;
+}
+
+static void sweepAxis(float boxMin, float boxMax, float otherMin, float otherMax, float delta, float &entry, float &exit) {
+	if (delta > 0) {
+		entry = (otherMin - boxMax) / delta;
+		exit = (otherMax - boxMin) / delta;
+	} else if (delta < 0) {
+		entry = (otherMax - boxMin) / delta;
+		exit = (otherMin - boxMax) / delta;
+	} else if (boxMin < otherMax && boxMax > otherMin) {
+		entry = -std::numeric_limits<float>::infinity();
+		exit = std::numeric_limits<float>::infinity();
+	} else {
+		entry = std::numeric_limits<float>::infinity();
+		exit = -std::numeric_limits<float>::infinity();
+	}
+}
+
+void SweepBatch(const AABB &box, float dx, float dy, const float *minX, const float *minY, const float *maxX, const float *maxY, const float *otherDx, const float *otherDy, size_t count, float *timesOfImpact) {
+	for (size_t i = 0; i < count; i++) {
+		float entryX, exitX, entryY, exitY;
+		sweepAxis(box.minX, box.maxX, minX[i], maxX[i], dx - otherDx[i], entryX, exitX);
+		sweepAxis(box.minY, box.maxY, minY[i], maxY[i], dy - otherDy[i], entryY, exitY);
+
+		float entry = std::max(entryX, entryY);
+		float exit = std::min(exitX, exitY);
+
+		bool isHit = entry < exit && exit > 0 && entry <= 1;
+		timesOfImpact[i] = isHit ? std::max(entry, 0.0f) : 2.0f;
+	}
+}
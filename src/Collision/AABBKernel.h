@@ -0,0 +1,22 @@
+#ifndef AABB_KERNEL_H
+#define AABB_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include "AABB.h"
+
+// Each kernel tests `box` against `count` boxes stored as SoA arrays and writes one bit per box
+// into hitMasks (LSB first, 8 boxes per byte). hitMasks must hold (count + 7) / 8 bytes.
+void OverlapBatchScalar(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count, uint8_t *hitMasks);
+void OverlapBatchSSE2(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count, uint8_t *hitMasks);
+void OverlapBatchAVX2(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count, uint8_t *hitMasks);
+
+// Dispatches to the widest kernel supported by the running CPU.
+void OverlapBatch(const AABB &box, const float *minX, const float *minY, const float *maxX, const float *maxY, size_t count, uint8_t *hitMasks);
+const char *OverlapBatchKernelName();
+
+// Sweeps `box`, moving by (dx, dy) over one step, against `count` boxes given at the start of the step and
+// moving by (otherDx, otherDy). Writes the normalised time of impact for each box, or a value above 1 on a miss.
+void SweepBatch(const AABB &box, float dx, float dy, const float *minX, const float *minY, const float *maxX, const float *maxY, const float *otherDx, const float *otherDy, size_t count, float *timesOfImpact);
+
+#endif // AABB_KERNEL_H
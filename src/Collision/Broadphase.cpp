@@ -0,0 +1,118 @@
+#include <cmath>
+#include <algorithm>
+#include "Broadphase.h"
+
+Broadphase::Broadphase(float cellSize) {
+	this->cellSize = cellSize;
+	this->cellWidth = cellSize;
+	this->cellHeight = cellSize;
+	this->originX = 0;
+	this->originY = 0;
+	this->numCols = 1;
+	this->numRows = 1;
+}
+
+int Broadphase::cellCoord(float value, float origin, float extent, int numCells) const {
+	int coord = static_cast<int>(std::floor((value - origin) / extent));
+	return std::clamp(coord, 0, numCells - 1);
+}
+
+void Broadphase::Build(const AABBArray &boxes) {
+	const size_t numBoxes = boxes.Size();
+
+	float minX = 0, minY = 0, maxX = 0, maxY = 0;
+	if (numBoxes > 0) {
+		minX = *std::min_element(boxes.minX.begin(), boxes.minX.end());
+		minY = *std::min_element(boxes.minY.begin(), boxes.minY.end());
+		maxX = *std::max_element(boxes.maxX.begin(), boxes.maxX.end());
+		maxY = *std::max_element(boxes.maxY.begin(), boxes.maxY.end());
+	}
+
+	originX = minX;
+	originY = minY;
+	// Very large worlds get coarser cells rather than an unbounded number of them.
+	cellWidth = std::max(cellSize, (maxX - minX) / MAX_CELLS_PER_AXIS);
+	cellHeight = std::max(cellSize, (maxY - minY) / MAX_CELLS_PER_AXIS);
+	numCols = std::clamp(static_cast<int>((maxX - minX) / cellWidth) + 1, 1, MAX_CELLS_PER_AXIS);
+	numRows = std::clamp(static_cast<int>((maxY - minY) / cellHeight) + 1, 1, MAX_CELLS_PER_AXIS);
+
+	const size_t numCells = NumCells();
+	cellStart.assign(numCells + 1, 0);
+
+	int minCol, minRow, maxCol, maxRow;
+	for (size_t i = 0; i < numBoxes; i++) {
+		GetCellRange(boxes.Get(i), minCol, minRow, maxCol, maxRow);
+		for (int row = minRow; row <= maxRow; row++) {
+			for (int col = minCol; col <= maxCol; col++) {
+				cellStart[GetCellIndex(col, row) + 1]++;
+			}
+		}
+	}
+
+	for (size_t cell = 0; cell < numCells; cell++) {
+		cellStart[cell + 1] += cellStart[cell];
+	}
+
+	cellItems.resize(cellStart[numCells]);
+	cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+
+	for (size_t i = 0; i < numBoxes; i++) {
+		GetCellRange(boxes.Get(i), minCol, minRow, maxCol, maxRow);
+		for (int row = minRow; row <= maxRow; row++) {
+			for (int col = minCol; col <= maxCol; col++) {
+				cellItems[cellFill[GetCellIndex(col, row)]++] = static_cast<uint32_t>(i);
+			}
+		}
+	}
+}
+
+size_t Broadphase::NumCells() const {
+	return static_cast<size_t>(numCols) * numRows;
+}
+
+int Broadphase::NumCols() const {
+	return numCols;
+}
+
+int Broadphase::NumRows() const {
+	return numRows;
+}
+
+float Broadphase::GetCellWidth() const {
+	return cellWidth;
+}
+
+float Broadphase::GetCellHeight() const {
+	return cellHeight;
+}
+
+AABB Broadphase::GetBounds() const {
+	return {originX, originY, originX + numCols * cellWidth, originY + numRows * cellHeight};
+}
+
+void Broadphase::GetCell(float x, float y, int &col, int &row) const {
+	col = cellCoord(x, originX, cellWidth, numCols);
+	row = cellCoord(y, originY, cellHeight, numRows);
+}
+
+const uint32_t *Broadphase::GetCellItems(size_t cell, size_t &count) const {
+	count = cellStart[cell + 1] - cellStart[cell];
+	return cellItems.data() + cellStart[cell];
+}
+
+size_t Broadphase::GetCellIndex(int col, int row) const {
+	return static_cast<size_t>(row) * numCols + col;
+}
+
+void Broadphase::GetCellRange(const AABB &box, int &minCol, int &minRow, int &maxCol, int &maxRow) const {
+	minCol = cellCoord(box.minX, originX, cellWidth, numCols);
+	minRow = cellCoord(box.minY, originY, cellHeight, numRows);
+	maxCol = cellCoord(box.maxX, originX, cellWidth, numCols);
+	maxRow = cellCoord(box.maxY, originY, cellHeight, numRows);
+}
+
+bool Broadphase::OwnsPair(size_t cell, const AABB &a, const AABB &b) const {
+	int col = cellCoord(std::max(a.minX, b.minX), originX, cellWidth, numCols);
+	int row = cellCoord(std::max(a.minY, b.minY), originY, cellHeight, numRows);
+	return GetCellIndex(col, row) == cell;
+}
@@ -0,0 +1,48 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <vector>
+#include <cstdint>
+#include "AABB.h"
+
+// Uniform grid rebuilt every frame with a counting sort, so every cell's box indices are contiguous
+// and no memory is allocated once the buffers have grown to the scene size.
+class Broadphase {
+private:
+	float cellSize;
+	float cellWidth;
+	float cellHeight;
+	float originX;
+	float originY;
+	int numCols;
+	int numRows;
+
+	std::vector<uint32_t> cellStart;
+	std::vector<uint32_t> cellItems;
+	std::vector<uint32_t> cellFill;
+
+	int cellCoord(float value, float origin, float extent, int numCells) const;
+
+public:
+	static constexpr int MAX_CELLS_PER_AXIS = 128;
+
+	Broadphase(float cellSize = 128.0f);
+
+	void Build(const AABBArray &boxes);
+
+	size_t NumCells() const;
+	int NumCols() const;
+	int NumRows() const;
+	float GetCellWidth() const;
+	float GetCellHeight() const;
+	AABB GetBounds() const;
+	void GetCell(float x, float y, int &col, int &row) const;
+	const uint32_t *GetCellItems(size_t cell, size_t &count) const;
+	size_t GetCellIndex(int col, int row) const;
+	void GetCellRange(const AABB &box, int &minCol, int &minRow, int &maxCol, int &maxRow) const;
+
+	// A pair shared by several cells is only reported by the cell holding the top-left corner of its overlap.
+	bool OwnsPair(size_t cell, const AABB &a, const AABB &b) const;
+};
+
+#endif // BROADPHASE_H
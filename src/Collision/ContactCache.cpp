@@ -0,0 +1,87 @@
+#include "ContactCache.h"
+
+ContactCache::ContactCache(size_t capacity) {
+	size_t powerOfTwo = 16;
+	while (powerOfTwo < capacity) powerOfTwo *= 2;
+
+	slots.assign(powerOfTwo, Slot{EMPTY_KEY, 0});
+	numOccupied = 0;
+	numDeleted = 0;
+	frame = 0;
+}
+
+uint64_t ContactCache::MakeKey(int a, int b) {
+	uint32_t lo = static_cast<uint32_t>(a < b ? a : b);
+	uint32_t hi = static_cast<uint32_t>(a < b ? b : a);
+	return (static_cast<uint64_t>(lo) << 32) | hi;
+}
+
+size_t ContactCache::probeStart(uint64_t key) const {
+	// splitmix64 finaliser, entity ids are small and sequential
+	key ^= key >> 30;
+	key *= 0xbf58476d1ce4e5b9ull;
+	key ^= key >> 27;
+	key *= 0x94d049bb133111ebull;
+	key ^= key >> 31;
+	return static_cast<size_t>(key) & (slots.size() - 1);
+}
+
+void ContactCache::rehash(size_t capacity) {
+	spareSlots.assign(capacity, Slot{EMPTY_KEY, 0});
+	spareSlots.swap(slots);
+	numDeleted = 0;
+
+	for (const auto &slot: spareSlots) {
+		if (slot.key >= DELETED_KEY) {
+			continue;
+		}
+		size_t idx = probeStart(slot.key);
+		while (slots[idx].key != EMPTY_KEY) {
+			idx = (idx + 1) & (slots.size() - 1);
+		}
+		slots[idx] = slot;
+	}
+}
+
+void ContactCache::BeginFrame() {
+	frame++;
+}
+
+bool ContactCache::Touch(int a, int b) {
+	if ((numOccupied + numDeleted + 1) * 10 > slots.size() * 7) {
+		rehash(numOccupied * 4 > slots.size() ? slots.size() * 2 : slots.size());
+	}
+
+	const uint64_t key = MakeKey(a, b);
+	size_t idx = probeStart(key);
+	size_t firstDeleted = slots.size();
+
+	while (slots[idx].key != EMPTY_KEY) {
+		if (slots[idx].key == key) {
+			slots[idx].lastFrame = frame;
+			return false;
+		}
+		if (slots[idx].key == DELETED_KEY && firstDeleted == slots.size()) {
+			firstDeleted = idx;
+		}
+		idx = (idx + 1) & (slots.size() - 1);
+	}
+
+	if (firstDeleted != slots.size()) {
+		idx = firstDeleted;
+		numDeleted--;
+	}
+	slots[idx] = {key, frame};
+	numOccupied++;
+	return true;
+}
+
+size_t ContactCache::Size() const {
+	return numOccupied;
+}
+
+void ContactCache::Clear() {
+	slots.assign(slots.size(), Slot{EMPTY_KEY, 0});
+	numOccupied = 0;
+	numDeleted = 0;
+}
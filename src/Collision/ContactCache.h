@@ -0,0 +1,60 @@
+#ifndef CONTACT_CACHE_H
+#define CONTACT_CACHE_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Set of touching entity pairs, stored in an open-addressing table with linear probing.
+// Each frame every live contact is touched; pairs that weren't touched are reported and dropped.
+class ContactCache {
+private:
+	static const uint64_t EMPTY_KEY = ~0ull;
+	static const uint64_t DELETED_KEY = ~0ull - 1;
+
+	struct Slot {
+		uint64_t key;
+		uint32_t lastFrame;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<Slot> spareSlots;
+	size_t numOccupied;
+	size_t numDeleted;
+	uint32_t frame;
+
+	size_t probeStart(uint64_t key) const;
+	void rehash(size_t capacity);
+
+public:
+	ContactCache(size_t capacity = 256);
+
+	static uint64_t MakeKey(int a, int b);
+
+	void BeginFrame();
+	// Returns true when the pair wasn't already in the cache.
+	bool Touch(int a, int b);
+	size_t Size() const;
+	void Clear();
+
+	template <typename TFunc> void RemoveStale(TFunc onRemoved);
+};
+
+template <typename TFunc>
+void ContactCache::RemoveStale(TFunc onRemoved) {
+	for (auto &slot: slots) {
+		if (slot.key >= DELETED_KEY || slot.lastFrame == frame) {
+			continue;
+		}
+		onRemoved(static_cast<int>(slot.key >> 32), static_cast<int>(slot.key & 0xffffffff));
+		slot.key = DELETED_KEY;
+		numOccupied--;
+		numDeleted++;
+	}
+
+	if (numDeleted > slots.size() / 4) {
+		rehash(slots.size());
+	}
+}
+
+#endif // CONTACT_CACHE_H
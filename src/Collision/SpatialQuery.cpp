@@ -0,0 +1,237 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "SpatialQuery.h"
+
+SpatialQuery::SpatialQuery(const Broadphase &broadphase, const AABBArray &boxes, const std::vector<Entity> &entities):
+	broadphase(broadphase), boxes(boxes), entities(entities) {
+	stamp = 0;
+}
+
+bool SpatialQuery::beginVisit() {
+	if (boxes.Size() == 0) {
+		return false;
+	}
+	if (stamps.size() < boxes.Size()) {
+		stamps.resize(boxes.Size(), 0);
+	}
+	stamp++;
+	return true;
+}
+
+bool SpatialQuery::visit(uint32_t idx) {
+	if (stamps[idx] == stamp) {
+		return false;
+	}
+	stamps[idx] = stamp;
+	return true;
+}
+
+static float distanceSqToBox(glm::vec2 point, const AABB &box) {
+	float dx = std::max(std::max(box.minX - point.x, 0.0f), point.x - box.maxX);
+	float dy = std::max(std::max(box.minY - point.y, 0.0f), point.y - box.maxY);
+	return dx * dx + dy * dy;
+}
+
+const std::vector<Entity> &SpatialQuery::QueryAABB(const AABB &area) {
+	results.clear();
+	if (!beginVisit()) {
+		return results;
+	}
+
+	int minCol, minRow, maxCol, maxRow;
+	broadphase.GetCellRange(area, minCol, minRow, maxCol, maxRow);
+	for (int row = minRow; row <= maxRow; row++) {
+		for (int col = minCol; col <= maxCol; col++) {
+			size_t count;
+			const uint32_t *items = broadphase.GetCellItems(broadphase.GetCellIndex(col, row), count);
+			for (size_t i = 0; i < count; i++) {
+				if (visit(items[i]) && AABBOverlaps(area, boxes.Get(items[i]))) {
+					results.push_back(entities[items[i]]);
+				}
+			}
+		}
+	}
+	return results;
+}
+
+const std::vector<Entity> &SpatialQuery::QueryRadius(glm::vec2 centre, float radius) {
+	results.clear();
+	if (!beginVisit()) {
+		return results;
+	}
+
+	const AABB area = {centre.x - radius, centre.y - radius, centre.x + radius, centre.y + radius};
+	int minCol, minRow, maxCol, maxRow;
+	broadphase.GetCellRange(area, minCol, minRow, maxCol, maxRow);
+	for (int row = minRow; row <= maxRow; row++) {
+		for (int col = minCol; col <= maxCol; col++) {
+			size_t count;
+			const uint32_t *items = broadphase.GetCellItems(broadphase.GetCellIndex(col, row), count);
+			for (size_t i = 0; i < count; i++) {
+				if (visit(items[i]) && distanceSqToBox(centre, boxes.Get(items[i])) <= radius * radius) {
+					results.push_back(entities[items[i]]);
+				}
+			}
+		}
+	}
+	return results;
+}
+
+// Searches rings of cells around the point, stopping once no unvisited cell can hold anything closer than the
+// k-th best candidate. Distances are measured to the box centre, which always lies in a cell the box was binned in.
+const std::vector<Entity> &SpatialQuery::Nearest(glm::vec2 point, size_t k, const std::string &group) {
+	results.clear();
+	neighbours.clear();
+	if (k == 0 || !beginVisit()) {
+		return results;
+	}
+
+	int originCol, originRow;
+	broadphase.GetCell(point.x, point.y, originCol, originRow);
+	const int maxRing = std::max(broadphase.NumCols(), broadphase.NumRows());
+	const float ringExtent = std::min(broadphase.GetCellWidth(), broadphase.GetCellHeight());
+
+	for (int ring = 0; ring <= maxRing; ring++) {
+		for (int row = originRow - ring; row <= originRow + ring; row++) {
+			if (row < 0 || row >= broadphase.NumRows()) {
+				continue;
+			}
+			const bool isEdgeRow = row == originRow - ring || row == originRow + ring;
+			const int colStep = isEdgeRow ? 1 : std::max(ring * 2, 1);
+
+			for (int col = originCol - ring; col <= originCol + ring; col += colStep) {
+				if (col < 0 || col >= broadphase.NumCols()) {
+					continue;
+				}
+
+				size_t count;
+				const uint32_t *items = broadphase.GetCellItems(broadphase.GetCellIndex(col, row), count);
+				for (size_t i = 0; i < count; i++) {
+					const uint32_t idx = items[i];
+					if (!visit(idx)) {
+						continue;
+					}
+					if (!group.empty() && !entities[idx].InGroup(group)) {
+						continue;
+					}
+
+					const AABB box = boxes.Get(idx);
+					const glm::vec2 centre((box.minX + box.maxX) / 2, (box.minY + box.maxY) / 2);
+					const glm::vec2 delta = centre - point;
+					const Neighbour neighbour = {delta.x * delta.x + delta.y * delta.y, idx};
+
+					if (neighbours.size() < k) {
+						neighbours.push_back(neighbour);
+						std::push_heap(neighbours.begin(), neighbours.end());
+					} else if (neighbour < neighbours.front()) {
+						std::pop_heap(neighbours.begin(), neighbours.end());
+						neighbours.back() = neighbour;
+						std::push_heap(neighbours.begin(), neighbours.end());
+					}
+				}
+			}
+		}
+
+		const float searched = ring * ringExtent;
+		if (neighbours.size() == k && neighbours.front().distanceSq <= searched * searched) {
+			break;
+		}
+	}
+
+	std::sort_heap(neighbours.begin(), neighbours.end());
+	for (auto neighbour: neighbours) {
+		results.push_back(entities[neighbour.idx]);
+	}
+	return results;
+}
+
+static bool rayHitsBox(glm::vec2 origin, glm::vec2 invDirection, const AABB &box, float maxDistance, float &distance) {
+	float tx1 = (box.minX - origin.x) * invDirection.x;
+	float tx2 = (box.maxX - origin.x) * invDirection.x;
+	float ty1 = (box.minY - origin.y) * invDirection.y;
+	float ty2 = (box.maxY - origin.y) * invDirection.y;
+
+	float tEnter = std::max(std::min(tx1, tx2), std::min(ty1, ty2));
+	float tExit = std::min(std::max(tx1, tx2), std::max(ty1, ty2));
+
+	if (tExit < 0 || tEnter > tExit || tEnter > maxDistance) {
+		return false;
+	}
+	distance = std::max(tEnter, 0.0f);
+	return true;
+}
+
+// Walks the grid cells along the ray (Amanatides & Woo) and stops at the first cell that contains a hit
+// closer than the point where the ray leaves that cell.
+bool SpatialQuery::Raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance, RaycastHit &hit, int ignoreEntityId) {
+	const float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	if (length == 0 || !beginVisit()) {
+		return false;
+	}
+	direction /= length;
+
+	const float inf = std::numeric_limits<float>::infinity();
+	const glm::vec2 invDirection(direction.x != 0 ? 1.0f / direction.x : inf, direction.y != 0 ? 1.0f / direction.y : inf);
+
+	float tStart;
+	if (!rayHitsBox(origin, invDirection, broadphase.GetBounds(), maxDistance, tStart)) {
+		return false;
+	}
+
+	const glm::vec2 start = origin + direction * tStart;
+	int col, row;
+	broadphase.GetCell(start.x, start.y, col, row);
+
+	const AABB bounds = broadphase.GetBounds();
+	const float cellWidth = broadphase.GetCellWidth();
+	const float cellHeight = broadphase.GetCellHeight();
+	const int stepCol = direction.x > 0 ? 1 : -1;
+	const int stepRow = direction.y > 0 ? 1 : -1;
+	const float deltaX = std::abs(cellWidth * invDirection.x);
+	const float deltaY = std::abs(cellHeight * invDirection.y);
+
+	float nextX = direction.x == 0 ? inf : ((bounds.minX + (col + (stepCol > 0 ? 1 : 0)) * cellWidth) - origin.x) * invDirection.x;
+	float nextY = direction.y == 0 ? inf : ((bounds.minY + (row + (stepRow > 0 ? 1 : 0)) * cellHeight) - origin.y) * invDirection.y;
+
+	float bestDistance = inf;
+	uint32_t bestIdx = 0;
+
+	while (col >= 0 && col < broadphase.NumCols() && row >= 0 && row < broadphase.NumRows()) {
+		size_t count;
+		const uint32_t *items = broadphase.GetCellItems(broadphase.GetCellIndex(col, row), count);
+		for (size_t i = 0; i < count; i++) {
+			const uint32_t idx = items[i];
+			if (!visit(idx) || entities[idx].GetId() == ignoreEntityId) {
+				continue;
+			}
+			float distance;
+			if (rayHitsBox(origin, invDirection, boxes.Get(idx), maxDistance, distance) && distance < bestDistance) {
+				bestDistance = distance;
+				bestIdx = idx;
+			}
+		}
+
+		const float cellExit = std::min(nextX, nextY);
+		if (bestDistance <= cellExit || cellExit > maxDistance) {
+			break;
+		}
+
+		if (nextX < nextY) {
+			col += stepCol;
+			nextX += deltaX;
+		} else {
+			row += stepRow;
+			nextY += deltaY;
+		}
+	}
+
+	if (bestDistance == inf) {
+		return false;
+	}
+
+	hit.entity = entities[bestIdx];
+	hit.distance = bestDistance;
+	hit.point = origin + direction * bestDistance;
+	return true;
+}
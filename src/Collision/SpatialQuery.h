@@ -0,0 +1,53 @@
+#ifndef SPATIAL_QUERY_H
+#define SPATIAL_QUERY_H
+
+#include <vector>
+#include <string>
+#include <glm/glm.hpp>
+#include "../ECS/ECS.h"
+#include "AABB.h"
+#include "Broadphase.h"
+
+struct RaycastHit {
+	Entity entity;
+	float distance;
+	glm::vec2 point;
+
+	RaycastHit(): entity(-1), distance(0), point(0) {}
+};
+
+// Read-only queries over the colliders as of the last CollisionSystem::Update. Results are written into
+// buffers owned by the query object, so the returned vectors are only valid until the next query.
+class SpatialQuery {
+private:
+	struct Neighbour {
+		float distanceSq;
+		uint32_t idx;
+
+		bool operator <(const Neighbour &other) const {
+			return distanceSq != other.distanceSq ? distanceSq < other.distanceSq : idx < other.idx;
+		}
+	};
+
+	const Broadphase &broadphase;
+	const AABBArray &boxes;
+	const std::vector<Entity> &entities;
+
+	std::vector<uint32_t> stamps;
+	uint32_t stamp;
+	std::vector<Entity> results;
+	std::vector<Neighbour> neighbours;
+
+	bool beginVisit();
+	bool visit(uint32_t idx);
+
+public:
+	SpatialQuery(const Broadphase &broadphase, const AABBArray &boxes, const std::vector<Entity> &entities);
+
+	const std::vector<Entity> &QueryAABB(const AABB &area);
+	const std::vector<Entity> &QueryRadius(glm::vec2 centre, float radius);
+	const std::vector<Entity> &Nearest(glm::vec2 point, size_t k, const std::string &group = "");
+	bool Raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance, RaycastHit &hit, int ignoreEntityId = -1);
+};
+
+#endif // SPATIAL_QUERY_H
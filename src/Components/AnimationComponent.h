@@ -2,20 +2,28 @@
 #define ANIMATION_COMPONENT_H
 
 #include <SDL2/SDL.h>
+#include "../Game/Clock.h"
 
+// Frames are laid out left to right from the sprite's source rect, wrapping onto the next row of the sheet every
+// numColumns frames (0 keeps them all on one row). A clip that doesn't loop stops on its last frame. An
+// AnimationEvent is queued when the clip reaches eventFrame (-1 for none) and when a non-looping clip finishes.
 struct AnimationComponent {
 	int numFrames;
 	int currentFrame;
 	int frameRateSpeed;
 	bool isLoop;
 	int startTime;
+	int numColumns;
+	int eventFrame;
 
-	AnimationComponent(int numFrames = 1, int frameRateSpeed = 1, bool isLoop = true) {
+	AnimationComponent(int numFrames = 1, int frameRateSpeed = 1, bool isLoop = true, int numColumns = 0, int eventFrame = -1) {
 		this->numFrames = numFrames;
-		this->currentFrame = 1;
+		this->currentFrame = 0;
 		this->frameRateSpeed = frameRateSpeed;
 		this->isLoop = isLoop;
-		this->startTime = SDL_GetTicks();
+		this->startTime = Clock::GetTicks();
+		this->numColumns = numColumns;
+		this->eventFrame = eventFrame;
 	}
 };
 
@@ -9,12 +9,20 @@ struct BoxColliderComponent {
 	int height;
 	glm::vec2 offset;
 	SDL_Color colour;
+	int numContacts;
+	bool isFast;
+	glm::vec2 previousPosition;
+	bool hasPreviousPosition;
 
-	BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0)) {
+	BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0), bool isFast = false) {
 		this->width = width;
 		this->height = height;
 		this->offset = offset;
 		this->colour = {255, 255, 0, 255};
+		this->numContacts = 0;
+		this->isFast = isFast;
+		this->previousPosition = glm::vec2(0);
+		this->hasPreviousPosition = false;
 	}
 };
 
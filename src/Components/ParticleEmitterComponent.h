@@ -0,0 +1,65 @@
+#ifndef PARTICLE_EMITTER_COMPONENT_H
+#define PARTICLE_EMITTER_COMPONENT_H
+
+#include <SDL2/SDL.h>
+#include <glm/glm.hpp>
+
+// Particles are emitted from the entity's position plus offset, at rate per second and in bursts of burstCount:
+// one when the emitter is added and one for every emit_particles call from Lua. They leave in a random direction
+// within spread degrees either side of direction (clockwise from +x), and live on after the entity is destroyed.
+struct ParticleEmitterComponent {
+	float rate;
+	int burstCount;
+	glm::vec2 offset;
+	float direction;
+	float spread;
+	float minSpeed;
+	float maxSpeed;
+	float minLifetime;
+	float maxLifetime;
+	float gravity;
+	float startSize;
+	float endSize;
+	SDL_Color startColor;
+	SDL_Color endColor;
+
+	// Fractions of a particle left over from earlier steps, and particles queued by bursts.
+	float emissionDebt;
+	int pendingBurst;
+
+	ParticleEmitterComponent(
+		float rate = 0,
+		int burstCount = 0,
+		glm::vec2 offset = glm::vec2(0),
+		float direction = 0,
+		float spread = 180,
+		float minSpeed = 0,
+		float maxSpeed = 0,
+		float minLifetime = 1,
+		float maxLifetime = 1,
+		float gravity = 0,
+		float startSize = 2,
+		float endSize = 2,
+		SDL_Color startColor = {255, 255, 255, 255},
+		SDL_Color endColor = {255, 255, 255, 0}
+	) {
+		this->rate = rate;
+		this->burstCount = burstCount;
+		this->offset = offset;
+		this->direction = direction;
+		this->spread = spread;
+		this->minSpeed = minSpeed;
+		this->maxSpeed = maxSpeed;
+		this->minLifetime = minLifetime;
+		this->maxLifetime = maxLifetime;
+		this->gravity = gravity;
+		this->startSize = startSize;
+		this->endSize = endSize;
+		this->startColor = startColor;
+		this->endColor = endColor;
+		this->emissionDebt = 0;
+		this->pendingBurst = burstCount;
+	}
+};
+
+#endif // PARTICLE_EMITTER_COMPONENT_H
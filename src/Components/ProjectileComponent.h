@@ -2,6 +2,7 @@
 #define PROJECTILE_COMPONENT_H
 
 #include <SDL2/SDL.h>
+#include "../Game/Clock.h"
 
 struct ProjectileComponent {
 	bool isFriendly;
@@ -13,7 +14,7 @@ struct ProjectileComponent {
 		this->isFriendly = isFriendly;
 		this->hitPercentDamage = hitPercentDamage;
 		this->duration = duration;
-		this->startTime = SDL_GetTicks();
+		this->startTime = Clock::GetTicks();
 	}
 };
 
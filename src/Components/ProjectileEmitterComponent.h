@@ -2,6 +2,7 @@
 #define PROJECTILE_EMITTER_COMPONENT_H
 
 #include <SDL2/SDL.h>
+#include "../Game/Clock.h"
 #include <glm/glm.hpp>
 
 struct ProjectileEmitterComponent {
@@ -24,7 +25,7 @@ struct ProjectileEmitterComponent {
 		this->projectileDuration = projectileDuration;
 		this->hitPercentDamage = hitPercentDamage;
 		this->isFriendly = isFriendly;
-		this->lastEmissionTime = SDL_GetTicks();
+		this->lastEmissionTime = Clock::GetTicks();
 	}
 };
 
@@ -4,6 +4,8 @@
 #include <string>
 #include <SDL2/SDL.h>
 
+struct TextureRegion;
+
 struct SpriteComponent {
 	std::string assetId;
 	int width;
@@ -12,6 +14,7 @@ struct SpriteComponent {
 	bool isFixed;
 	SDL_RendererFlip isFlipped;
 	SDL_Rect srcRect;
+	const TextureRegion *texture;
 
 	SpriteComponent(
 		std::string assetId = "",
@@ -30,6 +33,7 @@ struct SpriteComponent {
 		this->isFixed = isFixed;
 		this->srcRect = {srcRectX, srcRectY, width, height};
 		this->isFlipped = isFlipped;
+		this->texture = nullptr;
 	}
 };
 
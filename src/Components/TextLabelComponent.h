@@ -12,18 +12,24 @@ struct TextLabelComponent {
 	SDL_Color color;
 	bool isFixed;
 
+	// Large labels are rendered once into a texture from the AssetStore's text cache instead of being drawn as
+	// glyph quads; see RenderTextSystem.
+	bool isCached;
+
 	TextLabelComponent(
 		glm::vec2 position = glm::vec2(0),
 		std::string text = "",
 		std::string assetId = "",
 		SDL_Color color = {0, 0, 0},
-		bool isFixed = true
+		bool isFixed = true,
+		bool isCached = false
 	) {
 		this->position = position;
 		this->text = text,
 		this->assetId = assetId,
 		this->color = color;
 		this->isFixed = isFixed;
+		this->isCached = isCached;
 	}
 };
 
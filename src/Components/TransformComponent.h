@@ -7,11 +7,16 @@ struct TransformComponent {
 	glm::vec2 position;
 	glm::vec2 scale;
 	float rotation;
+	// As of the start of the current simulation step; rendering blends from these to the current values.
+	glm::vec2 previousPosition;
+	float previousRotation;
 
 	TransformComponent(glm::vec2 pos = glm::vec2(0.0, 0.0), glm::vec2 scale = glm::vec2(1.0, 1.0), double rotation = 0.0) {
 		this->position = pos;
 		this->scale = scale;
 		this->rotation = rotation;
+		this->previousPosition = pos;
+		this->previousRotation = rotation;
 	}
 };
 
@@ -3,6 +3,9 @@
 
 int BaseComponent::nextId = 0;
 
+std::unordered_map<std::string, int> EntityManager::groupBits;
+std::unordered_map<std::string, int> EntityManager::tagBits;
+
 void Entity::Kill() {
 	entityManager->KillEntity(*this);
 }
@@ -29,15 +32,20 @@ bool Entity::InGroup(const std::string &group) const {
 
 void System::AddEntitySystem(Entity entity) {
 	entities.push_back(entity);
+	OnEntityAdded(entity);
 }
 
 void System::RemoveEntitySystem(Entity entity) {
-	entities.erase(std::remove_if(entities.begin(), entities.end(), [&entity](Entity other) {
+	auto removed = std::remove_if(entities.begin(), entities.end(), [&entity](Entity other) {
 		return entity == other;
-	}), entities.end());
+	});
+	if (removed != entities.end()) {
+		entities.erase(removed, entities.end());
+		OnEntityRemoved(entity);
+	}
 }
 
-std::vector<Entity> System::GetSystemEntities() const {
+const std::vector<Entity> &System::GetSystemEntities() const {
 	return entities;
 }
 
@@ -78,6 +86,11 @@ size_t EntityManager::NumEntites() const {
 void EntityManager::TagEntity(Entity entity, const std::string &tag) {
 	entityByTag.emplace(tag, entity);
 	tagByEntity.emplace(entity.GetId(), tag);
+
+	if (entity.GetId() >= static_cast<int>(entityTagMasks.size())) {
+		entityTagMasks.resize(entity.GetId() + 1, 0);
+	}
+	entityTagMasks[entity.GetId()] |= GetTagMask(tag);
 }
 
 bool EntityManager::EntityHasTag(Entity entity, const std::string &tag) const {
@@ -98,20 +111,28 @@ void EntityManager::RemoveEntityTag(Entity entity) {
 		entityByTag.erase(tag);
 		tagByEntity.erase(taggedEntity);
 	}
+	if (entity.GetId() < static_cast<int>(entityTagMasks.size())) {
+		entityTagMasks[entity.GetId()] = 0;
+	}
 }
 
 void EntityManager::GroupEntity(Entity entity, const std::string &group) {
 	entitiesByGroup.emplace(group, std::set<Entity>());
 	entitiesByGroup[group].emplace(entity);
 	groupByEntity.emplace(entity.GetId(), group);
+
+	if (entity.GetId() >= static_cast<int>(entityGroupMasks.size())) {
+		entityGroupMasks.resize(entity.GetId() + 1, 0);
+	}
+	entityGroupMasks[entity.GetId()] |= GetGroupMask(group);
 }
 
 bool EntityManager::EntityInGroup(Entity entity, const std::string &group) const {
-	if (entitiesByGroup.find(group) == entitiesByGroup.end()) {
+	auto groupEntities = entitiesByGroup.find(group);
+	if (groupEntities == entitiesByGroup.end()) {
 		return false;
 	}
-	auto groupEntities = entitiesByGroup.at(group);
-	return groupEntities.find(entity.GetId()) != groupEntities.end();
+	return groupEntities->second.find(entity.GetId()) != groupEntities->second.end();
 }
 
 std::vector<Entity> EntityManager::GetEntitiesByGroup(const std::string &group) const {
@@ -134,6 +155,41 @@ void EntityManager::RemoveEntityroup(Entity entity) {
 		}
 		groupByEntity.erase(groupedEntity);
 	}
+	if (entity.GetId() < static_cast<int>(entityGroupMasks.size())) {
+		entityGroupMasks[entity.GetId()] = 0;
+	}
+}
+
+int EntityManager::getBit(std::unordered_map<std::string, int> &bits, const std::string &name) {
+	auto bit = bits.find(name);
+	if (bit != bits.end()) {
+		return bit->second;
+	}
+	if (bits.size() >= MAX_FILTER_BITS) {
+		Logger::Err("too many groups or tags to filter on, ignoring " + name);
+		return -1;
+	}
+	const int newBit = static_cast<int>(bits.size());
+	bits.emplace(name, newBit);
+	return newBit;
+}
+
+uint64_t EntityManager::GetGroupMask(const std::string &group) {
+	const int bit = getBit(groupBits, group);
+	return bit < 0 ? 0 : uint64_t(1) << bit;
+}
+
+uint64_t EntityManager::GetTagMask(const std::string &tag) {
+	const int bit = getBit(tagBits, tag);
+	return bit < 0 ? 0 : uint64_t(1) << bit;
+}
+
+EntityFilter EntityFilter::Group(const std::string &group) {
+	return EntityFilter(EntityManager::GetGroupMask(group), 0, false);
+}
+
+EntityFilter EntityFilter::Tag(const std::string &tag) {
+	return EntityFilter(0, EntityManager::GetTagMask(tag), false);
 }
 
 void EntityManager::AddEntityToSystems(Entity entity) {
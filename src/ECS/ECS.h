@@ -10,6 +10,7 @@
 #include <memory>
 #include <algorithm>
 #include <deque>
+#include <cstdint>
 #include "../Logger/Logger.h"
 
 const unsigned int MAX_COMPONENTS = 32;
@@ -59,18 +60,51 @@ public:
 	class EntityManager *entityManager;
 };
 
+// Matches entities by group or tag using bit masks, so it can be checked without any string lookups. A default
+// constructed filter matches every entity.
+class EntityFilter {
+private:
+	uint64_t groups;
+	uint64_t tags;
+	bool matchesAll;
+
+	EntityFilter(uint64_t groups, uint64_t tags, bool matchesAll): groups(groups), tags(tags), matchesAll(matchesAll) {}
+
+public:
+	EntityFilter(): groups(0), tags(0), matchesAll(true) {}
+
+	static EntityFilter Group(const std::string &group);
+	static EntityFilter Tag(const std::string &tag);
+
+	EntityFilter operator |(const EntityFilter &other) const {
+		return EntityFilter(groups | other.groups, tags | other.tags, matchesAll || other.matchesAll);
+	}
+
+	bool MatchesAll() const {
+		return matchesAll;
+	}
+
+	bool Matches(Entity entity) const;
+};
+
 class System {
 private:
 	Signature componentSignature;
 	std::vector<Entity> entities;
 
+protected:
+	// Called when an entity starts or stops matching the system's signature, for systems that keep their own
+	// per-entity state.
+	virtual void OnEntityAdded(Entity entity) {}
+	virtual void OnEntityRemoved(Entity entity) {}
+
 public:
 	System() = default;
-	~System() = default;
+	virtual ~System() = default;
 
 	void AddEntitySystem(Entity entity);
 	void RemoveEntitySystem(Entity entity);
-	std::vector<Entity> GetSystemEntities() const;
+	const std::vector<Entity> &GetSystemEntities() const;
 	const Signature& GetComponentSignature() const;
 
 	template <typename T> void RequireComponent();
@@ -153,8 +187,9 @@ public:
 		}
 	}
 
+	// Doesn't modify the pool, so render workers can look components up at the same time.
 	T& Get(size_t entityId) {
-		size_t idx = entityIdToIdx[entityId];
+		size_t idx = entityIdToIdx.find(entityId)->second;
 		return static_cast<T&>(data[idx]);
 	}
 
@@ -181,6 +216,15 @@ private:
 	std::unordered_map<std::string, std::set<Entity>> entitiesByGroup;
 	std::unordered_map<int, std::string> groupByEntity;
 
+	// Group and tag names get a bit each the first time they're used, shared by every EntityManager.
+	static const int MAX_FILTER_BITS = 64;
+	static std::unordered_map<std::string, int> groupBits;
+	static std::unordered_map<std::string, int> tagBits;
+	std::vector<uint64_t> entityGroupMasks;
+	std::vector<uint64_t> entityTagMasks;
+
+	static int getBit(std::unordered_map<std::string, int> &bits, const std::string &name);
+
 public:
 	EntityManager() = default;
 
@@ -200,6 +244,11 @@ public:
 	std::vector<Entity> GetEntitiesByGroup(const std::string &group) const;
 	void RemoveEntityroup(Entity entity);
 
+	static uint64_t GetGroupMask(const std::string &group);
+	static uint64_t GetTagMask(const std::string &tag);
+	uint64_t GetEntityGroupMask(int entityId) const;
+	uint64_t GetEntityTagMask(int entityId) const;
+
 	template <typename T, typename ...TArgs> void AddComponent(Entity entity, TArgs&& ...args);
 	template <typename T> void RemoveComponent(Entity entity);
 	template <typename T> bool HasComponent(Entity entity) const;
@@ -214,6 +263,22 @@ public:
 	void RemoveEntityFromSystems(Entity entity);
 };
 
+inline uint64_t EntityManager::GetEntityGroupMask(int entityId) const {
+	return entityId < static_cast<int>(entityGroupMasks.size()) ? entityGroupMasks[entityId] : 0;
+}
+
+inline uint64_t EntityManager::GetEntityTagMask(int entityId) const {
+	return entityId < static_cast<int>(entityTagMasks.size()) ? entityTagMasks[entityId] : 0;
+}
+
+inline bool EntityFilter::Matches(Entity entity) const {
+	if (matchesAll) {
+		return true;
+	}
+	const EntityManager *entityManager = entity.entityManager;
+	return (entityManager->GetEntityGroupMask(entity.GetId()) & groups) || (entityManager->GetEntityTagMask(entity.GetId()) & tags);
+}
+
 template <typename T>
 void System::RequireComponent() {
 	const auto componentId = Component<T>::GetId();
@@ -291,7 +356,7 @@ template <typename T>
 T& EntityManager::GetComponent(Entity entity) const {
 	const auto componentId = Component<T>::GetId();
 	const auto entityId = entity.GetId();
-	auto componentPool = std::static_pointer_cast<Pool<T>>(componentPools[componentId]);
+	Pool<T> *componentPool = static_cast<Pool<T>*>(componentPools[componentId].get());
 	return componentPool->Get(entityId);
 }
 
@@ -0,0 +1,168 @@
+#ifndef CONCURRENT_EVENT_QUEUE_H
+#define CONCURRENT_EVENT_QUEUE_H
+
+#include <vector>
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <utility>
+
+// Multi-producer, single-consumer queue. Every producer gets a slot index, fixed when the queue is created, and
+// appends to its own list of chunks, so pushing never takes a lock and only touches memory owned by that producer.
+// The consumer drains the producers in slot order and each producer's events in the order they were pushed, which
+// makes the drained order deterministic as long as the producers are done when Drain is called.
+//
+// Fully drained chunks are handed back to their producer through a lock-free stack. The consumer is the only
+// thread that pushes to it and the producer takes the whole stack at once, so there's no ABA problem.
+template <typename TEvent>
+class ConcurrentEventQueue {
+private:
+	static const size_t CHUNK_SIZE = 256;
+
+	struct Chunk {
+		alignas(TEvent) unsigned char storage[CHUNK_SIZE * sizeof(TEvent)];
+		std::atomic<size_t> count;
+		std::atomic<Chunk*> next;
+		Chunk *nextFree;
+
+		Chunk(): count(0), next(nullptr), nextFree(nullptr) {}
+
+		TEvent *Get(size_t idx) {
+			return reinterpret_cast<TEvent*>(storage) + idx;
+		}
+	};
+
+	// Producer and consumer state live on separate cache lines so they don't slow each other down.
+	struct alignas(64) Producer {
+		Chunk *tail;
+		Chunk *freeChunks;
+		std::atomic<Chunk*> returnedChunks;
+	};
+
+	struct alignas(64) Consumer {
+		Chunk *head;
+		size_t numRead;
+	};
+
+	std::vector<Producer> producers;
+	std::vector<Consumer> consumers;
+
+	Chunk *takeFreeChunk(Producer &producer) {
+		if (!producer.freeChunks) {
+			producer.freeChunks = producer.returnedChunks.exchange(nullptr, std::memory_order_acquire);
+		}
+		Chunk *chunk = producer.freeChunks;
+		if (!chunk) {
+			return new Chunk();
+		}
+		producer.freeChunks = chunk->nextFree;
+		chunk->count.store(0, std::memory_order_relaxed);
+		chunk->next.store(nullptr, std::memory_order_relaxed);
+		return chunk;
+	}
+
+	void returnChunk(Producer &producer, Chunk *chunk) {
+		Chunk *top = producer.returnedChunks.load(std::memory_order_relaxed);
+		do {
+			chunk->nextFree = top;
+		} while (!producer.returnedChunks.compare_exchange_weak(top, chunk, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	static void deleteFreeList(Chunk *chunk) {
+		while (chunk) {
+			Chunk *nextFree = chunk->nextFree;
+			delete chunk;
+			chunk = nextFree;
+		}
+	}
+
+public:
+	ConcurrentEventQueue(size_t numProducers): producers(numProducers), consumers(numProducers) {
+		for (size_t i = 0; i < numProducers; i++) {
+			Chunk *chunk = new Chunk();
+			producers[i].tail = chunk;
+			producers[i].freeChunks = nullptr;
+			producers[i].returnedChunks.store(nullptr, std::memory_order_relaxed);
+			consumers[i].head = chunk;
+			consumers[i].numRead = 0;
+		}
+	}
+
+	~ConcurrentEventQueue() {
+		for (size_t i = 0; i < producers.size(); i++) {
+			Chunk *chunk = consumers[i].head;
+			size_t numRead = consumers[i].numRead;
+			while (chunk) {
+				const size_t count = chunk->count.load(std::memory_order_acquire);
+				for (size_t j = numRead; j < count; j++) {
+					chunk->Get(j)->~TEvent();
+				}
+				Chunk *next = chunk->next.load(std::memory_order_acquire);
+				delete chunk;
+				chunk = next;
+				numRead = 0;
+			}
+			deleteFreeList(producers[i].freeChunks);
+			deleteFreeList(producers[i].returnedChunks.load(std::memory_order_acquire));
+		}
+	}
+
+	ConcurrentEventQueue(const ConcurrentEventQueue&) = delete;
+	ConcurrentEventQueue &operator =(const ConcurrentEventQueue&) = delete;
+
+	size_t NumProducers() const {
+		return producers.size();
+	}
+
+	// Only ever called from the thread that owns the producer slot.
+	template <typename ...TArgs>
+	void Push(size_t producerIdx, TArgs&& ...args) {
+		Producer &producer = producers[producerIdx];
+		Chunk *chunk = producer.tail;
+		size_t count = chunk->count.load(std::memory_order_relaxed);
+
+		if (count == CHUNK_SIZE) {
+			Chunk *next = takeFreeChunk(producer);
+			chunk->next.store(next, std::memory_order_release);
+			producer.tail = next;
+			chunk = next;
+			count = 0;
+		}
+
+		new (chunk->Get(count)) TEvent(std::forward<TArgs>(args)...);
+		chunk->count.store(count + 1, std::memory_order_release);
+	}
+
+	// Only ever called from the consumer thread. Events pushed while draining may or may not be included.
+	template <typename TFunc>
+	size_t Drain(TFunc &&func) {
+		size_t numDrained = 0;
+		for (size_t i = 0; i < producers.size(); i++) {
+			Consumer &consumer = consumers[i];
+			while (true) {
+				Chunk *chunk = consumer.head;
+				const size_t count = chunk->count.load(std::memory_order_acquire);
+				for (; consumer.numRead < count; consumer.numRead++) {
+					TEvent *event = chunk->Get(consumer.numRead);
+					func(*event);
+					event->~TEvent();
+					numDrained++;
+				}
+
+				if (consumer.numRead < CHUNK_SIZE) {
+					break;
+				}
+				Chunk *next = chunk->next.load(std::memory_order_acquire);
+				if (!next) {
+					break;
+				}
+				consumer.head = next;
+				consumer.numRead = 0;
+				returnChunk(producers[i], chunk);
+			}
+		}
+		return numDrained;
+	}
+};
+
+#endif // CONCURRENT_EVENT_QUEUE_H
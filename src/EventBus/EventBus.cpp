@@ -0,0 +1,3 @@
+#include "EventBus.h"
+
+int BaseEventType::nextId = 0;
@@ -1,50 +1,299 @@
 #ifndef EVENTBUS_H
 #define EVENTBUS_H
 
-#include <map>
-#include <typeindex>
-#include <list>
-#include <functional>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include "../ECS/ECS.h"
 #include "../Logger/Logger.h"
 #include "./Event.h"
+#include "./ConcurrentEventQueue.h"
 
-class BaseEventCallback {
+struct BaseEventType {
+protected:
+	static int nextId;
+};
+
+// Dense ids for event types, assigned on first use like component ids.
+template <typename TEvent>
+class EventType: public BaseEventType {
+public:
+	static int GetId() {
+		static auto id = nextId++;
+		return id;
+	}
+};
+
+// The events handed to batch subscribers; only valid for the duration of the call. When the subscription has a
+// filter the span only visits the events that passed it.
+template <typename TEvent>
+class EventSpan {
 private:
-	virtual void call(Event &e) = 0;
+	TEvent *events;
+	const uint32_t *indices;
+	size_t count;
 
 public:
-	virtual ~BaseEventCallback() = default;
+	class Iterator {
+	private:
+		const EventSpan *span;
+		size_t idx;
+
+	public:
+		Iterator(const EventSpan *span, size_t idx): span(span), idx(idx) {}
+
+		TEvent &operator *() const { return (*span)[idx]; }
+		Iterator &operator ++() { idx++; return *this; }
+		bool operator !=(const Iterator &other) const { return idx != other.idx; }
+	};
+
+	EventSpan(TEvent *events, const uint32_t *indices, size_t count): events(events), indices(indices), count(count) {}
+
+	Iterator begin() const { return Iterator(this, 0); }
+	Iterator end() const { return Iterator(this, count); }
+	size_t Size() const { return count; }
+	TEvent &operator [](size_t idx) const { return indices ? events[indices[idx]] : events[idx]; }
+};
+
+// Events with two Entity members named a and b, like the collision events, can be filtered at subscribe time.
+template <typename TEvent, typename = void>
+struct HasEntityPair: std::false_type {};
+
+template <typename TEvent>
+struct HasEntityPair<TEvent, std::void_t<decltype(std::declval<TEvent&>().a), decltype(std::declval<TEvent&>().b)>>:
+	std::integral_constant<bool,
+		std::is_same<std::decay_t<decltype(std::declval<TEvent&>().a)>, Entity>::value &&
+		std::is_same<std::decay_t<decltype(std::declval<TEvent&>().b)>, Entity>::value> {};
 
-	void Execute(Event &e) {
-		call(e);
+// Passes events where one entity matches first and the other matches second, in either order.
+struct EventFilter {
+	EntityFilter first;
+	EntityFilter second;
+
+	EventFilter(EntityFilter first, EntityFilter second = EntityFilter()): first(first), second(second) {}
+
+	bool Matches(Entity a, Entity b) const {
+		return (first.Matches(a) && second.Matches(b)) || (first.Matches(b) && second.Matches(a));
 	}
 };
 
-template <typename TOwner, typename TEvent>
-class EventCallback: public BaseEventCallback {
+// Returned by SubscribeToEvent and used to unsubscribe; a default constructed subscription refers to nothing.
+class EventSubscription {
 private:
-	typedef void (TOwner::*CallbackFunc)(TEvent&);
+	int eventType;
+	size_t id;
 
-	TOwner *ownerInstance;
-	CallbackFunc callbackFunc;
+	EventSubscription(int eventType, size_t id): eventType(eventType), id(id) {}
 
-	virtual void call(Event &e) override {
-		std::invoke(callbackFunc, ownerInstance, static_cast<TEvent&>(e));
-	}
+	friend class EventBus;
 
 public:
-	EventCallback(TOwner *ownerInstance, CallbackFunc callbackFunc) {
-		this->ownerInstance = ownerInstance;
-		this->callbackFunc = callbackFunc;
+	EventSubscription(): eventType(-1), id(0) {}
+
+	bool IsValid() const {
+		return id != 0;
 	}
-	~EventCallback() override = default;
 };
 
-typedef std::list<std::unique_ptr<BaseEventCallback>> HandlerList;
-
+// Subscriptions persist until they are unsubscribed or the bus is reset. A handler unsubscribed while events are
+// being dispatched isn't called again, not even for the rest of the batch being dispatched; it's only erased once
+// the outermost dispatch returns. Handlers added while dispatching are first called for the next event.
+//
+// EmitEvent calls the handlers right away. QueueEvent appends the event to a per-type queue instead, and the queues
+// are handed out by DispatchQueuedEvents: batch subscribers get every queued event of their type in one call, while
+// regular subscribers are still called once per event. Both kinds of subscriber see both kinds of event.
+//
+// Worker threads can't touch the bus itself, but they can EmitEventConcurrent into event types registered with
+// RegisterConcurrentEvent. Those events join the queue at the next DispatchQueuedEvents, after the events queued on
+// the main thread and in producer order. Registering, and queueing an event type for the first time, must not
+// happen while workers are emitting.
 class EventBus {
 private:
-	std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers;
+	typedef void (*CallbackFunc)(void *owner, void *events, const uint32_t *indices, size_t begin, size_t end);
+	typedef size_t (*FilterFunc)(void *events, size_t count, const EventFilter &filter, uint32_t *indices);
+
+	// Unsubscribed handlers are kept, with an id of 0, until it's safe to erase them.
+	struct Handler {
+		size_t id;
+		void *owner;
+		CallbackFunc callback;
+		FilterFunc filterFunc;
+		EventFilter filter;
+		bool isBatch;
+	};
+
+	struct HandlerList {
+		std::vector<Handler> handlers;
+		bool hasRemovedHandlers = false;
+	};
+
+	// Events queued while a queue is being dispatched go to the pending buffer and are handed out on the next pass.
+	class BaseEventQueue {
+	public:
+		virtual ~BaseEventQueue() = default;
+		virtual bool BeginDispatch() = 0;
+		virtual void *Data() = 0;
+		virtual size_t Size() const = 0;
+		virtual void EndDispatch() = 0;
+		virtual void Clear() = 0;
+	};
+
+	template <typename TEvent>
+	class EventQueue: public BaseEventQueue {
+	public:
+		std::vector<TEvent> pending;
+		std::vector<TEvent> dispatching;
+		std::unique_ptr<ConcurrentEventQueue<TEvent>> concurrent;
+
+		void DrainConcurrent() {
+			if (concurrent) {
+				concurrent->Drain([this](TEvent &event) {
+					pending.push_back(std::move(event));
+				});
+			}
+		}
+
+		bool BeginDispatch() override {
+			DrainConcurrent();
+			std::swap(pending, dispatching);
+			return !dispatching.empty();
+		}
+		void *Data() override { return dispatching.data(); }
+		size_t Size() const override { return dispatching.size(); }
+		void EndDispatch() override { dispatching.clear(); }
+		void Clear() override {
+			DrainConcurrent();
+			pending.clear();
+		}
+	};
+
+	static const int MAX_DISPATCH_PASSES = 16;
+
+	std::vector<HandlerList> subscribers;
+	std::vector<std::unique_ptr<BaseEventQueue>> queues;
+	size_t nextSubscriptionId = 1;
+	int dispatchDepth = 0;
+	bool hasRemovedHandlers = false;
+	std::vector<std::vector<uint32_t>> filteredIndices;
+
+	template <typename TEvent, auto Callback, typename TOwner>
+	static void invoke(void *owner, void *events, const uint32_t *indices, size_t begin, size_t end) {
+		TEvent *typedEvents = static_cast<TEvent*>(events);
+		for (size_t i = begin; i < end; i++) {
+			(static_cast<TOwner*>(owner)->*Callback)(typedEvents[indices ? indices[i] : i]);
+		}
+	}
+
+	template <typename TEvent, auto Callback, typename TOwner>
+	static void invokeBatch(void *owner, void *events, const uint32_t *indices, size_t begin, size_t end) {
+		TEvent *typedEvents = static_cast<TEvent*>(events);
+		(static_cast<TOwner*>(owner)->*Callback)(indices ?
+			EventSpan<TEvent>(typedEvents, indices + begin, end - begin) :
+			EventSpan<TEvent>(typedEvents + begin, nullptr, end - begin));
+	}
+
+	template <typename TEvent>
+	static size_t filterEvents(void *events, size_t count, const EventFilter &filter, uint32_t *indices) {
+		TEvent *typedEvents = static_cast<TEvent*>(events);
+		size_t numPassed = 0;
+		for (size_t i = 0; i < count; i++) {
+			if (filter.Matches(typedEvents[i].a, typedEvents[i].b)) {
+				indices[numPassed++] = static_cast<uint32_t>(i);
+			}
+		}
+		return numPassed;
+	}
+
+	EventSubscription subscribe(int eventType, void *ownerInstance, CallbackFunc callback, bool isBatch, FilterFunc filterFunc = nullptr, const EventFilter &filter = EventFilter(EntityFilter())) {
+		if (eventType >= static_cast<int>(subscribers.size())) {
+			subscribers.resize(eventType + 1);
+		}
+		const size_t id = nextSubscriptionId++;
+		subscribers[eventType].handlers.push_back({id, ownerInstance, callback, filterFunc, filter, isBatch});
+		return EventSubscription(eventType, id);
+	}
+
+	template <typename TEvent>
+	EventQueue<TEvent> &getQueue() {
+		const int eventType = EventType<TEvent>::GetId();
+		if (eventType >= static_cast<int>(queues.size())) {
+			queues.resize(eventType + 1);
+		}
+		if (!queues[eventType]) {
+			queues[eventType] = std::make_unique<EventQueue<TEvent>>();
+		}
+		return *static_cast<EventQueue<TEvent>*>(queues[eventType].get());
+	}
+
+	// Calls a handler for events [0, count), or for the events indices picks out. Regular handlers are called
+	// one event at a time and stop as soon as they're unsubscribed; batch handlers get all the events at once.
+	void invokeHandler(int eventType, size_t handlerIdx, const Handler &handler, void *events, const uint32_t *indices, size_t count) {
+		if (handler.isBatch) {
+			handler.callback(handler.owner, events, indices, 0, count);
+			return;
+		}
+		for (size_t i = 0; i < count; i++) {
+			if (subscribers[eventType].handlers[handlerIdx].id != handler.id) {
+				return;
+			}
+			handler.callback(handler.owner, events, indices, i, i + 1);
+		}
+	}
+
+	// Handlers may subscribe while being called, so the lists are indexed again on every iteration.
+	void dispatch(int eventType, void *events, size_t count) {
+		if (eventType >= static_cast<int>(subscribers.size())) {
+			return;
+		}
+
+		const size_t numHandlers = subscribers[eventType].handlers.size();
+		dispatchDepth++;
+		if (dispatchDepth > static_cast<int>(filteredIndices.size())) {
+			filteredIndices.resize(dispatchDepth);
+		}
+
+		for (size_t i = 0; i < numHandlers; i++) {
+			const Handler handler = subscribers[eventType].handlers[i];
+			if (handler.id == 0) {
+				continue;
+			}
+			if (!handler.filterFunc) {
+				invokeHandler(eventType, i, handler, events, nullptr, count);
+				continue;
+			}
+
+			// Each dispatch depth has its own index buffer, so a handler emitting events can't overwrite the
+			// indices it's iterating over.
+			std::vector<uint32_t> &indices = filteredIndices[dispatchDepth - 1];
+			indices.resize(std::max(indices.size(), count));
+			const size_t numPassed = handler.filterFunc(events, count, handler.filter, indices.data());
+			if (numPassed > 0) {
+				invokeHandler(eventType, i, handler, events, indices.data(), numPassed);
+			}
+		}
+		dispatchDepth--;
+
+		if (dispatchDepth == 0) {
+			removeUnsubscribed();
+		}
+	}
+
+	void removeUnsubscribed() {
+		if (!hasRemovedHandlers) {
+			return;
+		}
+		hasRemovedHandlers = false;
+		for (auto &list: subscribers) {
+			if (!list.hasRemovedHandlers) {
+				continue;
+			}
+			list.handlers.erase(std::remove_if(list.handlers.begin(), list.handlers.end(), [](const Handler &handler) {
+				return handler.id == 0;
+			}), list.handlers.end());
+			list.hasRemovedHandlers = false;
+		}
+	}
 
 public:
 	EventBus() {
@@ -55,28 +304,131 @@ public:
 	}
 
 	void Reset() {
+		if (dispatchDepth > 0) {
+			Logger::Err("EventBus cannot be reset while an event is being dispatched");
+			return;
+		}
 		subscribers.clear();
+		for (auto &queue: queues) {
+			if (queue) {
+				queue->Clear();
+			}
+		}
+	}
+
+	// Usage: eventBus->SubscribeToEvent<CollisionEnterEvent, &DamageSystem::OnCollision>(this);
+	template <typename TEvent, auto Callback, typename TOwner>
+	EventSubscription SubscribeToEvent(TOwner *ownerInstance) {
+		return subscribe(EventType<TEvent>::GetId(), ownerInstance, &EventBus::invoke<TEvent, Callback, TOwner>, false);
+	}
+
+	// Usage: eventBus->SubscribeToEventBatch<CollisionEnterEvent, &DamageSystem::OnCollisions>(this);
+	// where the callback takes an EventSpan<CollisionEnterEvent>.
+	template <typename TEvent, auto Callback, typename TOwner>
+	EventSubscription SubscribeToEventBatch(TOwner *ownerInstance) {
+		return subscribe(EventType<TEvent>::GetId(), ownerInstance, &EventBus::invokeBatch<TEvent, Callback, TOwner>, true);
+	}
+
+	// The handler is only called for events whose entities pass the filter, e.g.
+	// EventFilter(EntityFilter::Group("projectiles")) for collisions where either side is a projectile.
+	template <typename TEvent, auto Callback, typename TOwner>
+	EventSubscription SubscribeToEvent(TOwner *ownerInstance, const EventFilter &filter) {
+		static_assert(HasEntityPair<TEvent>::value, "only events with Entity members a and b can be filtered");
+		return subscribe(EventType<TEvent>::GetId(), ownerInstance, &EventBus::invoke<TEvent, Callback, TOwner>, false, &EventBus::filterEvents<TEvent>, filter);
 	}
 
-	template <typename TEvent, typename TOwner>
-	void SubscribeToEvent(TOwner *ownerInstance, void (TOwner::*callbackFunc)(TEvent&)) {
-		if (!subscribers[typeid(TEvent)].get()) {
-			subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
+	template <typename TEvent, auto Callback, typename TOwner>
+	EventSubscription SubscribeToEventBatch(TOwner *ownerInstance, const EventFilter &filter) {
+		static_assert(HasEntityPair<TEvent>::value, "only events with Entity members a and b can be filtered");
+		return subscribe(EventType<TEvent>::GetId(), ownerInstance, &EventBus::invokeBatch<TEvent, Callback, TOwner>, true, &EventBus::filterEvents<TEvent>, filter);
+	}
+
+	void Unsubscribe(EventSubscription &subscription) {
+		if (!subscription.IsValid()) {
+			return;
+		}
+		if (subscription.eventType < static_cast<int>(subscribers.size())) {
+			HandlerList &list = subscribers[subscription.eventType];
+			for (auto &handler: list.handlers) {
+				if (handler.id == subscription.id) {
+					handler.id = 0;
+					list.hasRemovedHandlers = true;
+					hasRemovedHandlers = true;
+					break;
+				}
+			}
+		}
+		subscription = EventSubscription();
+
+		if (dispatchDepth == 0) {
+			removeUnsubscribed();
 		}
-		auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunc);
-		subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
 	}
 
 	template <typename TEvent, typename ...TArgs>
 	void EmitEvent(TArgs&& ...args) {
-		auto handlers = subscribers[typeid(TEvent)].get();
-		if (handlers) {
-			for (auto it = handlers->begin(); it != handlers->end(); it++) {
-				auto handler = it->get();
-				TEvent event(std::forward<TArgs>(args)...);
-				handler->Execute(event);
+		const int eventType = EventType<TEvent>::GetId();
+		if (eventType >= static_cast<int>(subscribers.size()) || subscribers[eventType].handlers.empty()) {
+			return;
+		}
+		TEvent event(std::forward<TArgs>(args)...);
+		dispatch(eventType, &event, 1);
+	}
+
+	template <typename TEvent, typename ...TArgs>
+	void QueueEvent(TArgs&& ...args) {
+		getQueue<TEvent>().pending.emplace_back(std::forward<TArgs>(args)...);
+	}
+
+	// Producers are numbered from 0, e.g. by ThreadPool thread index.
+	template <typename TEvent>
+	void RegisterConcurrentEvent(size_t numProducers) {
+		EventQueue<TEvent> &queue = getQueue<TEvent>();
+		if (queue.concurrent && queue.concurrent->NumProducers() == numProducers) {
+			return;
+		}
+		queue.DrainConcurrent();
+		queue.concurrent = std::make_unique<ConcurrentEventQueue<TEvent>>(numProducers);
+	}
+
+	// Safe to call from any thread, as long as each producer index is only used by one thread at a time.
+	// Returns false if the event type wasn't registered for that many producers.
+	template <typename TEvent, typename ...TArgs>
+	bool EmitEventConcurrent(size_t producerIdx, TArgs&& ...args) {
+		const int eventType = EventType<TEvent>::GetId();
+		if (eventType >= static_cast<int>(queues.size()) || !queues[eventType]) {
+			return false;
+		}
+		ConcurrentEventQueue<TEvent> *concurrent = static_cast<EventQueue<TEvent>*>(queues[eventType].get())->concurrent.get();
+		if (!concurrent || producerIdx >= concurrent->NumProducers()) {
+			return false;
+		}
+		concurrent->Push(producerIdx, std::forward<TArgs>(args)...);
+		return true;
+	}
+
+	// Hands out the queued events by event type. Events queued by the handlers are dispatched in further passes.
+	void DispatchQueuedEvents() {
+		if (dispatchDepth > 0) {
+			Logger::Err("EventBus cannot dispatch queued events from inside an event handler");
+			return;
+		}
+		for (int pass = 0; pass < MAX_DISPATCH_PASSES; pass++) {
+			bool hasDispatched = false;
+			for (size_t eventType = 0; eventType < queues.size(); eventType++) {
+				BaseEventQueue *queue = queues[eventType].get();
+				if (!queue || !queue->BeginDispatch()) {
+					continue;
+				}
+				hasDispatched = true;
+				dispatch(static_cast<int>(eventType), queue->Data(), queue->Size());
+				queue->EndDispatch();
+			}
+			if (!hasDispatched) {
+				return;
 			}
 		}
+		Logger::Err("EventBus gave up dispatching queued events; handlers keep queueing new ones");
 	}
 };
 
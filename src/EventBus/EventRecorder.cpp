@@ -0,0 +1,110 @@
+#include "EventRecorder.h"
+#include "../Logger/Logger.h"
+
+static const uint32_t RECORDING_MAGIC = 0x31435645; // "EVC1"
+
+EventRecorder::~EventRecorder() {
+	Stop();
+}
+
+template <typename T>
+void EventRecorder::write(const T &value) {
+	output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool EventRecorder::read(T &value) {
+	input.read(reinterpret_cast<char*>(&value), sizeof(T));
+	return static_cast<bool>(input);
+}
+
+bool EventRecorder::StartRecording(const std::string &filePath, uint32_t seed, uint32_t startTicks) {
+	Stop();
+	output.open(filePath, std::ios::binary | std::ios::trunc);
+	if (!output) {
+		Logger::Err("could not open " + filePath + " to record events");
+		return false;
+	}
+	path = filePath;
+	write(RECORDING_MAGIC);
+	write(seed);
+	write(startTicks);
+	Logger::Info("recording events to " + path);
+	return true;
+}
+
+bool EventRecorder::StartReplay(const std::string &filePath, uint32_t &seed, uint32_t &startTicks) {
+	Stop();
+	input.open(filePath, std::ios::binary);
+	if (!input) {
+		Logger::Err("could not open " + filePath + " to replay events");
+		return false;
+	}
+
+	uint32_t magic;
+	if (!read(magic) || magic != RECORDING_MAGIC || !read(seed) || !read(startTicks)) {
+		Logger::Err(filePath + " is not an event recording");
+		input.close();
+		return false;
+	}
+	path = filePath;
+	Logger::Info("replaying events from " + path);
+	return true;
+}
+
+void EventRecorder::Stop() {
+	if (output.is_open()) {
+		output.close();
+		Logger::Info("finished recording events to " + path);
+	}
+	if (input.is_open()) {
+		input.close();
+	}
+}
+
+bool EventRecorder::IsRecording() const {
+	return output.is_open();
+}
+
+bool EventRecorder::IsReplaying() const {
+	return input.is_open();
+}
+
+void EventRecorder::RecordKeyPressed(uint32_t frame, SDL_Keycode key) {
+	write(static_cast<uint8_t>(RECORD_KEY_PRESSED));
+	write(frame);
+	write(static_cast<int32_t>(key));
+}
+
+void EventRecorder::RecordFrame(const RecordedFrame &frame) {
+	write(static_cast<uint8_t>(RECORD_FRAME));
+	write(frame.frame);
+	write(frame.deltaTime);
+	write(frame.ticks);
+}
+
+bool EventRecorder::ReplayFrame(std::vector<SDL_Keycode> &keysPressed, RecordedFrame &frame) {
+	keysPressed.clear();
+
+	uint8_t type;
+	uint32_t recordFrame;
+	while (read(type) && read(recordFrame)) {
+		if (type == RECORD_KEY_PRESSED) {
+			int32_t key;
+			if (!read(key)) {
+				break;
+			}
+			keysPressed.push_back(static_cast<SDL_Keycode>(key));
+		} else if (type == RECORD_FRAME) {
+			frame.frame = recordFrame;
+			if (!read(frame.deltaTime) || !read(frame.ticks)) {
+				break;
+			}
+			return true;
+		} else {
+			Logger::Err(path + " has an unknown record type, stopping the replay");
+			break;
+		}
+	}
+	return false;
+}
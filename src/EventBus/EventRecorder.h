@@ -0,0 +1,56 @@
+#ifndef EVENT_RECORDER_H
+#define EVENT_RECORDER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <SDL2/SDL.h>
+
+struct RecordedFrame {
+	uint32_t frame;
+	double deltaTime;
+	uint32_t ticks;
+};
+
+// Records the input of a play session, and the timing of every frame, to a binary log that can be replayed to get
+// the same simulation again. The log starts with a header holding the random seed and the clock at startup,
+// followed by one record per key press and per frame:
+//
+//   key press: uint8 type, uint32 frame, int32 key
+//   frame:     uint8 type, uint32 frame, float64 delta time, uint32 ticks
+//
+// Key presses are written before the record of the frame they happened in.
+class EventRecorder {
+private:
+	enum RecordType: uint8_t {
+		RECORD_KEY_PRESSED = 1,
+		RECORD_FRAME = 2
+	};
+
+	std::ofstream output;
+	std::ifstream input;
+	std::string path;
+
+	template <typename T> void write(const T &value);
+	template <typename T> bool read(T &value);
+
+public:
+	EventRecorder() = default;
+	~EventRecorder();
+
+	bool StartRecording(const std::string &filePath, uint32_t seed, uint32_t startTicks);
+	bool StartReplay(const std::string &filePath, uint32_t &seed, uint32_t &startTicks);
+	void Stop();
+
+	bool IsRecording() const;
+	bool IsReplaying() const;
+
+	void RecordKeyPressed(uint32_t frame, SDL_Keycode key);
+	void RecordFrame(const RecordedFrame &frame);
+
+	// Reads the key presses and the timing of the next recorded frame; returns false once the log is used up.
+	bool ReplayFrame(std::vector<SDL_Keycode> &keysPressed, RecordedFrame &frame);
+};
+
+#endif // EVENT_RECORDER_H
@@ -0,0 +1,17 @@
+#ifndef ANIMATION_EVENT_H
+#define ANIMATION_EVENT_H
+
+#include "../ECS/ECS.h"
+#include "../EventBus/Event.h"
+
+class AnimationEvent: public Event {
+public:
+	Entity entity;
+	int frame;
+	// Set when a clip that doesn't loop has shown its last frame; otherwise the clip reached its event frame.
+	bool isFinished;
+
+	AnimationEvent(Entity entity, int frame, bool isFinished): entity(entity), frame(frame), isFinished(isFinished) {}
+};
+
+#endif // ANIMATION_EVENT_H
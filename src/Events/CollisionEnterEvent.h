@@ -0,0 +1,16 @@
+#ifndef COLLISION_ENTER_EVENT_H
+#define COLLISION_ENTER_EVENT_H
+
+#include "../ECS/ECS.h"
+#include "../EventBus/Event.h"
+
+class CollisionEnterEvent: public Event {
+public:
+	Entity a;
+	Entity b;
+	float timeOfImpact;
+
+	CollisionEnterEvent(Entity a, Entity b, float timeOfImpact = 1.0f): a(a), b(b), timeOfImpact(timeOfImpact) {}
+};
+
+#endif // COLLISION_ENTER_EVENT_H
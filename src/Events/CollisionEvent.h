@@ -8,8 +8,10 @@ class CollisionEvent: public Event {
 public:
 	Entity a;
 	Entity b;
+	// Fraction of the last step at which the boxes first touched; 1 for boxes found overlapping at the end of it.
+	float timeOfImpact;
 
-	CollisionEvent(Entity a, Entity b): a(a), b(b) {}
+	CollisionEvent(Entity a, Entity b, float timeOfImpact = 1.0f): a(a), b(b), timeOfImpact(timeOfImpact) {}
 };
 
 #endif // COLLISION_EVENT_H
@@ -0,0 +1,16 @@
+#ifndef COLLISION_EXIT_EVENT_H
+#define COLLISION_EXIT_EVENT_H
+
+#include "../ECS/ECS.h"
+#include "../EventBus/Event.h"
+
+// Also sent when one side of the contact was killed, so check HasComponent before touching either entity.
+class CollisionExitEvent: public Event {
+public:
+	Entity a;
+	Entity b;
+
+	CollisionExitEvent(Entity a, Entity b): a(a), b(b) {}
+};
+
+#endif // COLLISION_EXIT_EVENT_H
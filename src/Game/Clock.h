@@ -0,0 +1,22 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <SDL2/SDL.h>
+
+// Game time in milliseconds, as of the start of the current frame. Gameplay code reads this instead of
+// SDL_GetTicks so that a replayed session sees exactly the times that were recorded.
+class Clock {
+private:
+	static Uint32 ticks;
+
+public:
+	static Uint32 GetTicks() {
+		return ticks;
+	}
+
+	static void SetTicks(Uint32 newTicks) {
+		ticks = newTicks;
+	}
+};
+
+#endif // CLOCK_H
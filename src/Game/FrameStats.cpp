@@ -0,0 +1,48 @@
+#include <algorithm>
+#include "FrameStats.h"
+#include "../Logger/Logger.h"
+
+bool FrameStats::Open(const std::string &path) {
+	output.open(path);
+	if (!output) {
+		Logger::Err("error opening frame stats file " + path);
+		return false;
+	}
+	output << "frame,update_ms,render_ms,frame_ms,entity_ids\n";
+	return true;
+}
+
+void FrameStats::Record(const FrameTiming &timing) {
+	frames.push_back(timing);
+	if (output) {
+		output << timing.frame << "," << timing.updateMs << "," << timing.renderMs << "," << timing.frameMs << "," << timing.numEntityIds << "\n";
+	}
+}
+
+void FrameStats::LogSummary() const {
+	if (frames.empty()) {
+		return;
+	}
+
+	std::vector<double> frameMs;
+	double totalUpdateMs = 0;
+	double totalRenderMs = 0;
+	for (const auto &timing: frames) {
+		frameMs.push_back(timing.frameMs);
+		totalUpdateMs += timing.updateMs;
+		totalRenderMs += timing.renderMs;
+	}
+	std::sort(frameMs.begin(), frameMs.end());
+
+	auto percentile = [&frameMs](double p) {
+		return frameMs[std::min(static_cast<size_t>(p * frameMs.size()), frameMs.size() - 1)];
+	};
+	const double numFrames = static_cast<double>(frames.size());
+	Logger::Info(
+		std::to_string(frames.size()) + " frames: update " + std::to_string(totalUpdateMs / numFrames) +
+		" ms, render " + std::to_string(totalRenderMs / numFrames) +
+		" ms, frame p50 " + std::to_string(percentile(0.5)) +
+		" ms, p95 " + std::to_string(percentile(0.95)) +
+		" ms, max " + std::to_string(frameMs.back()) + " ms"
+	);
+}
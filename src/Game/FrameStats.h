@@ -0,0 +1,32 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+struct FrameTiming {
+	uint32_t frame;
+	double updateMs;
+	double renderMs;
+	double frameMs;
+	size_t numEntityIds;
+};
+
+// Collects the timing of every frame and, if given a path, writes it out as CSV with one line per frame. A summary
+// with percentiles is logged at the end, so a performance regression shows up in the output of a headless run.
+class FrameStats {
+private:
+	std::ofstream output;
+	std::vector<FrameTiming> frames;
+
+public:
+	FrameStats() = default;
+
+	bool Open(const std::string &path);
+	void Record(const FrameTiming &timing);
+	void LogSummary() const;
+};
+
+#endif // FRAME_STATS_H
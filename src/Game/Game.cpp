@@ -1,3 +1,5 @@
+#include <random>
+#include <algorithm>
 #include <SDL2/SDL_image.h>
 #include <glm/glm.hpp>
 #include <imgui/imgui.h>
@@ -5,6 +7,7 @@
 #include <imgui/imgui_impl_sdl2.h>
 #include "Game.h"
 #include "LevelLoader.h"
+#include "Clock.h"
 #include "../ECS/ECS.h"
 #include "../Logger/Logger.h"
 #include "../Systems/MovementSystem.h"
@@ -21,6 +24,9 @@
 #include "../Systems/RenderHealthBarSystem.h"
 #include "../Systems/RenderGUISystem.h"
 #include "../Systems/ScriptSystem.h"
+#include "../Systems/VisibilitySystem.h"
+#include "../Systems/InterpolationSystem.h"
+#include "../Systems/ParticleSystem.h"
 #include "../Events/KeyPressedEvent.h"
 
 int Game::WindowWidth;
@@ -28,16 +34,32 @@ int Game::WindowHeight;
 int Game::MapWidth;
 int Game::MapHeight;
 
+Uint32 Clock::ticks = 0;
+
 const char *Game::Groups[] = {"ui", "tiles", "world", "player", "enemies", "projectiles"};
 
 Game::Game() {
     isRunning = false;
     isDebug = false;
     isPaused = false;
-    millisecsPreviousFrame = 0;
+    isHeadless = false;
+    isPipelined = false;
+    maxFrames = 0;
+    simulationHz = DEFAULT_SIMULATION_HZ;
+    renderHz = 0;
+    startTicks = 0;
+    accumulator = 0;
+    previousCounter = 0;
+    frontSnapshot = &snapshots[0];
+    backSnapshot = &snapshots[1];
+    frame = 0;
+    randomSeed = 0;
+    replayStart = 0;
     entityManager = std::make_unique<EntityManager>();
     assetStore = std::make_unique<AssetStore>();
     eventBus = std::make_unique<EventBus>();
+    threadPool = std::make_unique<ThreadPool>();
+    eventRecorder = std::make_unique<EventRecorder>();
 }
 
 Game::~Game() {}
@@ -45,7 +67,13 @@ Game::~Game() {}
 void Game::Init(bool debug) {
     Logger::Log = true;
 
-    if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
+    // Headless runs use SDL's dummy video driver and the software renderer, so they work without a display or GPU.
+    if (isHeadless) {
+	SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+	SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    }
+
+    if (SDL_Init(isHeadless ? SDL_INIT_VIDEO | SDL_INIT_TIMER : SDL_INIT_EVERYTHING) != 0) {
 	Logger::Err("error initing SDL");
 	return;
     }
@@ -66,20 +94,26 @@ void Game::Init(bool debug) {
 	    SDL_WINDOWPOS_CENTERED,
 	    WindowWidth,
 	    WindowHeight,
-	    SDL_WINDOW_BORDERLESS
+	    isHeadless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_BORDERLESS
     );
     if (window == nullptr) {
 	Logger::Err("error creating window");
 	return;
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+    if (isHeadless) {
+	rendererFlags = SDL_RENDERER_SOFTWARE;
+    } else if (renderHz == 0) {
+	rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+    renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     if (renderer == nullptr) {
 	Logger::Err("error creating renderer");
 	return;
     }
 
-    if (!debug)
+    if (!debug && !isHeadless)
 	SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
 
     isRunning = true;
@@ -96,18 +130,171 @@ void Game::Init(bool debug) {
     camera.y = 0;
     camera.w = WindowWidth;
     camera.h = WindowHeight;
+    previousCamera = camera;
 
     Logger::Info("game successfully initialised");
 }
 
+void Game::SetRecordPath(const std::string &path) {
+    recordPath = path;
+}
+
+// Replays run as fast as possible and skip rendering, so the run time only measures the simulation.
+void Game::SetReplayPath(const std::string &path) {
+    replayPath = path;
+}
+
+void Game::SetAtlasPath(const std::string &path) {
+    atlasPath = path;
+}
+
+void Game::SetAtlasOutPath(const std::string &path) {
+    atlasOutPath = path;
+}
+
+// Headless runs aren't capped and step the simulation once per frame, so two runs of the same build do the same
+// work and their frame times can be compared.
+void Game::SetHeadless(bool headless) {
+    isHeadless = headless;
+}
+
+// Stops the game after this many frames; 0 runs until quit.
+void Game::SetMaxFrames(uint32_t frames) {
+    maxFrames = frames;
+}
+
+void Game::SetStatsPath(const std::string &path) {
+    statsPath = path;
+}
+
+// The simulation always advances in steps of 1/hz seconds, however fast frames are drawn.
+void Game::SetSimulationHz(int hz) {
+    simulationHz = std::max(hz, 1);
+}
+
+// Caps the frame rate with a timer instead of vsync; 0 draws at the display's refresh rate.
+void Game::SetRenderHz(int hz) {
+    renderHz = std::max(hz, 0);
+}
+
+// Simulates the next frame on a second thread while the current one is drawn, which adds a frame of latency.
+// Replays don't render, so they always run on one thread.
+void Game::SetPipelined(bool pipelined) {
+    isPipelined = pipelined;
+}
+
+// Game time at the start of the current simulation step.
+Uint32 Game::simulationTicks() const {
+    return startTicks + static_cast<Uint32>(static_cast<uint64_t>(frame) * 1000 / simulationHz);
+}
+
+// SDL_Delay can oversleep by a millisecond or two, so the last stretch is spun.
+void Game::waitUntil(Uint64 counter) const {
+    const Uint64 countsPerMillisec = SDL_GetPerformanceFrequency() / 1000;
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (counter > now + 2 * countsPerMillisec) {
+	SDL_Delay(static_cast<Uint32>((counter - now) / countsPerMillisec - 2));
+    }
+    while (SDL_GetPerformanceCounter() < counter) {
+    }
+}
+
 void Game::Run() {
+    startTicks = SDL_GetTicks();
+    randomSeed = std::random_device()();
+    if (!replayPath.empty()) {
+	if (!eventRecorder->StartReplay(replayPath, randomSeed, startTicks)) {
+	    return;
+	}
+    } else if (!recordPath.empty()) {
+	eventRecorder->StartRecording(recordPath, randomSeed, startTicks);
+    }
+    Clock::SetTicks(startTicks);
+
     Setup();
+    if (!statsPath.empty()) {
+	frameStats.Open(statsPath);
+    }
+
+    const double millisecsPerCount = 1000.0 / SDL_GetPerformanceFrequency();
+    const bool isRendering = !eventRecorder->IsReplaying();
+    if (isPipelined && isRendering) {
+	simulationWorker = std::make_unique<Worker>();
+	extract(*frontSnapshot, 1.0f);
+    }
+    previousCounter = SDL_GetPerformanceCounter();
+    Uint64 nextRender = previousCounter;
+
+    replayStart = SDL_GetPerformanceCounter();
+    while (isRunning && (maxFrames == 0 || frame < maxFrames)) {
+	const Uint64 frameStart = SDL_GetPerformanceCounter();
+	const uint32_t frameNumber = frame;
+	if (eventRecorder->IsReplaying()) {
+	    replayInput();
+	    if (!isRunning) {
+		break;
+	    }
+	} else {
+	    ProcessInput();
+	}
+
+	double updateMs = 0.0;
+	double renderMs = 0.0;
+	if (simulationWorker) {
+	    // Frame N is drawn from the front snapshot while frame N+1 is simulated into the back one; the
+	    // simulation only ever runs between here and the Wait, so input and the debug GUI see it idle.
+	    auto simulateNext = [&]() {
+		const Uint64 updateStart = SDL_GetPerformanceCounter();
+		const float alpha = simulate();
+		extract(*backSnapshot, alpha);
+		updateMs = (SDL_GetPerformanceCounter() - updateStart) * millisecsPerCount;
+	    };
+	    simulationWorker->Start(simulateNext);
+
+	    const Uint64 renderStart = SDL_GetPerformanceCounter();
+	    Render(*frontSnapshot);
+	    simulationWorker->Wait();
+	    std::swap(frontSnapshot, backSnapshot);
+	    present();
+	    renderMs = (SDL_GetPerformanceCounter() - renderStart) * millisecsPerCount;
+	} else {
+	    const Uint64 updateStart = SDL_GetPerformanceCounter();
+	    const float alpha = simulate();
+	    if (isRendering) {
+		extract(*frontSnapshot, alpha);
+	    }
+	    const Uint64 renderStart = SDL_GetPerformanceCounter();
+	    if (isRendering) {
+		Render(*frontSnapshot);
+		present();
+	    }
+	    updateMs = (renderStart - updateStart) * millisecsPerCount;
+	    renderMs = (SDL_GetPerformanceCounter() - renderStart) * millisecsPerCount;
+	}
+	const Uint64 frameEnd = SDL_GetPerformanceCounter();
+
+	frameStats.Record({
+	    frameNumber,
+	    updateMs,
+	    renderMs,
+	    (frameEnd - frameStart) * millisecsPerCount,
+	    entityManager->NumEntites()
+	});
+
+	if (renderHz > 0 && !isHeadless && isRendering) {
+	    nextRender = std::max(nextRender + SDL_GetPerformanceFrequency() / renderHz, frameEnd);
+	    waitUntil(nextRender);
+	}
+    }
+    simulationWorker.reset();
+    frameStats.LogSummary();
 
-    while (isRunning) {
-	ProcessInput();
-	Update();
-	Render();
+    if (eventRecorder->IsReplaying()) {
+	const double seconds = static_cast<double>(SDL_GetPerformanceCounter() - replayStart) / SDL_GetPerformanceFrequency();
+	Logger::Info("replayed " + std::to_string(frame) + " frames in " + std::to_string(seconds * 1000.0) + " ms (" +
+		std::to_string(frame > 0 ? seconds * 1000.0 / frame : 0.0) + " ms per frame)");
     }
+    eventRecorder->Stop();
 }
 
 void Game::Setup() {
@@ -125,12 +312,29 @@ void Game::Setup() {
     entityManager->AddSystem<RenderHealthBarSystem>();
     entityManager->AddSystem<RenderGUISystem>();
     entityManager->AddSystem<ScriptSystem>();
+    entityManager->AddSystem<VisibilitySystem>();
+    entityManager->AddSystem<InterpolationSystem>();
+    entityManager->AddSystem<ParticleSystem>();
 
-    entityManager->GetSystem<ScriptSystem>().CreateScriptBindings(lua);
+    entityManager->GetSystem<DamageSystem>().SubscribeToEvents(eventBus);
+    entityManager->GetSystem<RenderColliderSystem>().SubscribeToEvents(eventBus);
+    entityManager->GetSystem<KeyboardControlSystem>().SubscribeToEvents(eventBus);
+    entityManager->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(eventBus);
+    entityManager->GetSystem<MovementSystem>().SubscribeToEvents(eventBus);
+
+    entityManager->GetSystem<ScriptSystem>().CreateScriptBindings(lua, entityManager->GetSystem<CollisionSystem>().GetSpatialQuery());
 
     LevelLoader loader;
     lua.open_libraries(sol::lib::base, sol::lib::os, sol::lib::math);
-    loader.LoadLevel(lua, entityManager, assetStore, renderer, 2);
+    if (eventRecorder->IsRecording() || eventRecorder->IsReplaying()) {
+	lua["math"]["randomseed"](randomSeed);
+    }
+    if (!atlasPath.empty()) {
+	assetStore->LoadAtlas(renderer, atlasPath);
+    }
+    loader.LoadLevel(lua, entityManager, assetStore, tilemap, renderer, 2);
+    assetStore->BuildAtlas(atlasOutPath);
+    tilemap->Build(renderer, assetStore);
 }
 
 void Game::ProcessInput() {
@@ -151,58 +355,144 @@ void Game::ProcessInput() {
 		isRunning = false;
 	    break;
 	    case SDL_KEYDOWN:
-		if (event.key.keysym.sym == SDLK_ESCAPE) {
-		    isRunning = false;
-		}
-		if (event.key.keysym.sym == SDLK_F1) {
-		    isDebug = !isDebug;
-		}
-		if (event.key.keysym.sym == SDLK_p) {
-		    isPaused = !isPaused;
-		}
-		eventBus->EmitEvent<KeyPressedEvent>(event.key.keysym.sym);
+		onKeyPressed(event.key.keysym.sym);
+	    break;
+	    // Render target contents are lost when the device is reset, e.g. on Direct3D when the window is resized.
+	    case SDL_RENDER_TARGETS_RESET:
+	    case SDL_RENDER_DEVICE_RESET:
+		tilemap->Rebuild(renderer);
 	    break;
 	}
     }
 }
 
-void Game::Update() {
-    int timeToWait = MILLISECS_PER_FRAME - (SDL_GetTicks() - millisecsPreviousFrame);
-    if (timeToWait > 0 && timeToWait <= MILLISECS_PER_FRAME) SDL_Delay(timeToWait);
+void Game::onKeyPressed(SDL_Keycode key) {
+    if (eventRecorder->IsRecording()) {
+	eventRecorder->RecordKeyPressed(frame, key);
+    }
 
-    double deltaTime = (SDL_GetTicks() - millisecsPreviousFrame) / 1000.0;
-    millisecsPreviousFrame = SDL_GetTicks();
+    if (key == SDLK_ESCAPE) {
+	isRunning = false;
+    }
+    if (key == SDLK_F1) {
+	isDebug = !isDebug;
+    }
+    if (key == SDLK_p) {
+	isPaused = !isPaused;
+    }
+    eventBus->EmitEvent<KeyPressedEvent>(key);
+}
 
-    if (isPaused)
+void Game::replayInput() {
+    if (!eventRecorder->ReplayFrame(replayedKeys, replayedFrame)) {
+	isRunning = false;
 	return;
+    }
+    if (replayedFrame.frame != frame) {
+	Logger::Err("replay is out of step, expected frame " + std::to_string(frame) + " but got " + std::to_string(replayedFrame.frame));
+    }
+    for (auto key: replayedKeys) {
+	onKeyPressed(key);
+    }
+}
 
-    eventBus->Reset();
-    entityManager->GetSystem<DamageSystem>().SubscribeToEvents(eventBus);
-    entityManager->GetSystem<RenderColliderSystem>().SubscribeToEvents(eventBus);
-    entityManager->GetSystem<KeyboardControlSystem>().SubscribeToEvents(eventBus);
-    entityManager->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(eventBus);
-    entityManager->GetSystem<MovementSystem>().SubscribeToEvents(eventBus);
+// Runs the simulation steps due this frame and returns how far into the next step the frame is drawn.
+float Game::simulate() {
+    const Uint64 countsPerStep = SDL_GetPerformanceFrequency() / simulationHz;
+    const double stepSeconds = 1.0 / simulationHz;
+
+    if (eventRecorder->IsReplaying()) {
+	Clock::SetTicks(replayedFrame.ticks);
+	Update(replayedFrame.deltaTime);
+	return 1.0f;
+    }
+    if (isHeadless) {
+	Clock::SetTicks(simulationTicks());
+	Update(stepSeconds);
+	return 1.0f;
+    }
+
+    // Real time is banked and spent in fixed steps; what's left over says how far to draw between the last
+    // two steps.
+    const Uint64 now = SDL_GetPerformanceCounter();
+    accumulator = std::min(accumulator + (now - previousCounter), countsPerStep * MAX_CATCH_UP_STEPS);
+    previousCounter = now;
+    while (accumulator >= countsPerStep && (maxFrames == 0 || frame < maxFrames)) {
+	Clock::SetTicks(simulationTicks());
+	Update(stepSeconds);
+	accumulator -= countsPerStep;
+    }
+    return static_cast<float>(accumulator) / countsPerStep;
+}
+
+// Copies what the render systems draw out of the registry. Culling uses the area both cameras cover, as the
+// frame is drawn somewhere between them.
+void Game::extract(RenderSnapshot &snapshot, float alpha) {
+    snapshot.Clear();
+    snapshot.frame = frame;
+    snapshot.alpha = alpha;
+    snapshot.previousCamera = previousCamera;
+    snapshot.camera = camera;
+
+    SDL_Rect view;
+    SDL_UnionRect(&previousCamera, &camera, &view);
+    auto &visibility = entityManager->GetSystem<VisibilitySystem>();
+    visibility.Update(view);
+
+    entityManager->GetSystem<RenderSystem>().Extract(snapshot, assetStore, visibility, threadPool);
+    entityManager->GetSystem<RenderTextSystem>().Extract(snapshot);
+    entityManager->GetSystem<RenderHealthBarSystem>().Extract(snapshot, visibility);
+    entityManager->GetSystem<ParticleSystem>().Extract(snapshot, view);
+    if (isDebug) {
+	entityManager->GetSystem<RenderColliderSystem>().Extract(snapshot, visibility);
+    }
+}
+
+void Game::Update(double deltaTime) {
+    if (eventRecorder->IsRecording()) {
+	eventRecorder->RecordFrame({frame, deltaTime, Clock::GetTicks()});
+    }
+    frame++;
+
+    // Kept up to date while paused too, so a paused frame doesn't jitter between the last two steps.
+    previousCamera = camera;
+    entityManager->GetSystem<InterpolationSystem>().Update();
+
+    if (isPaused)
+	return;
 
     entityManager->Update();
 
     entityManager->GetSystem<MovementSystem>().Update(deltaTime);
-    entityManager->GetSystem<AnimationSystem>().Update();
-    entityManager->GetSystem<CollisionSystem>().Update(eventBus);
+    entityManager->GetSystem<AnimationSystem>().Update(Clock::GetTicks(), eventBus);
+    entityManager->GetSystem<CollisionSystem>().Update(eventBus, threadPool);
+    eventBus->DispatchQueuedEvents();
     entityManager->GetSystem<ProjectileEmitSystem>().Update(entityManager);
     entityManager->GetSystem<CameraMovementSystem>().Update(camera);
     entityManager->GetSystem<ProjectileLifecycleSystem>().Update();
-    entityManager->GetSystem<ScriptSystem>().Update(deltaTime, SDL_GetTicks());
+    entityManager->GetSystem<ScriptSystem>().Update(deltaTime, Clock::GetTicks());
+    entityManager->GetSystem<ParticleSystem>().Update(deltaTime);
 }
 
-void Game::Render() {
+// Only reads the snapshot, so it can run while the next frame is simulated.
+void Game::Render(const RenderSnapshot &snapshot) {
     SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255);
     SDL_RenderClear(renderer);
 
-    entityManager->GetSystem<RenderSystem>().Update(renderer, camera, assetStore);
-    entityManager->GetSystem<RenderTextSystem>().Update(renderer, camera, assetStore);
-    entityManager->GetSystem<RenderHealthBarSystem>().Update(renderer, camera, assetStore);
+    tilemap->Draw(renderer, snapshot.InterpolatedCamera());
+    entityManager->GetSystem<RenderSystem>().Draw(renderer, snapshot);
+    entityManager->GetSystem<ParticleSystem>().Draw(renderer, snapshot);
+    entityManager->GetSystem<RenderTextSystem>().Draw(renderer, snapshot, assetStore);
+    entityManager->GetSystem<RenderHealthBarSystem>().Draw(renderer, snapshot, assetStore);
+    if (isDebug) {
+	entityManager->GetSystem<RenderColliderSystem>().Draw(snapshot, debugDraw);
+    }
+    debugDraw.Flush(renderer);
+}
+
+// The debug GUI reads and edits the registry, so this runs while the simulation is idle.
+void Game::present() {
     if (isDebug) {
-	entityManager->GetSystem<RenderColliderSystem>().Update(renderer, camera);
 	entityManager->GetSystem<RenderGUISystem>().Update(entityManager, camera);
     }
 
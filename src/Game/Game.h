@@ -6,37 +6,93 @@
 #include "../ECS/ECS.h"
 #include "../AssetStore/AssetStore.h"
 #include "../EventBus/EventBus.h"
+#include "../Jobs/ThreadPool.h"
+#include "../Jobs/Worker.h"
+#include "../EventBus/EventRecorder.h"
+#include "../Renderer/TilemapLayer.h"
+#include "../Renderer/RenderSnapshot.h"
+#include "../Renderer/DebugDraw.h"
+#include "FrameStats.h"
 
-const int FPS = 60;
-const int MILLISECS_PER_FRAME = 1000/FPS;
+const int DEFAULT_SIMULATION_HZ = 60;
+// After a stall the simulation catches up by at most this many steps per frame and drops the rest of the time.
+const int MAX_CATCH_UP_STEPS = 5;
 
 class Game {
 private:
 	SDL_Window *window;
 	SDL_Renderer *renderer;
 	SDL_Rect camera;
+	SDL_Rect previousCamera;
 
 	bool isRunning;
 	bool isDebug;
 	bool isPaused;
-	int millisecsPreviousFrame;
+	bool isHeadless;
+	bool isPipelined;
+	uint32_t maxFrames;
+	int simulationHz;
+	int renderHz;
+	Uint32 startTicks;
+	uint32_t frame;
+	Uint64 accumulator;
+	Uint64 previousCounter;
+
+	// The render side draws the front snapshot while the simulation fills the back one.
+	RenderSnapshot snapshots[2];
+	RenderSnapshot *frontSnapshot;
+	RenderSnapshot *backSnapshot;
+
+	std::string recordPath;
+	std::string replayPath;
+	std::string atlasPath;
+	std::string atlasOutPath;
+	std::string statsPath;
+	FrameStats frameStats;
+	DebugDraw debugDraw;
+	uint32_t randomSeed;
+	std::vector<SDL_Keycode> replayedKeys;
+	RecordedFrame replayedFrame;
+	Uint64 replayStart;
 
     sol::state lua;
 
 	std::unique_ptr<EntityManager> entityManager;
 	std::unique_ptr<AssetStore> assetStore;
 	std::unique_ptr<EventBus> eventBus;
+	std::unique_ptr<ThreadPool> threadPool;
+	std::unique_ptr<EventRecorder> eventRecorder;
+	std::unique_ptr<TilemapLayer> tilemap;
+	std::unique_ptr<Worker> simulationWorker;
+
+	void onKeyPressed(SDL_Keycode key);
+	void replayInput();
+	Uint32 simulationTicks() const;
+	float simulate();
+	void extract(RenderSnapshot &snapshot, float alpha);
+	void present();
+	void waitUntil(Uint64 counter) const;
 
 public:
 	Game();
 	~Game();
 
 	void Init(bool debug);
+	void SetRecordPath(const std::string &path);
+	void SetReplayPath(const std::string &path);
+	void SetAtlasPath(const std::string &path);
+	void SetAtlasOutPath(const std::string &path);
+	void SetHeadless(bool headless);
+	void SetMaxFrames(uint32_t frames);
+	void SetStatsPath(const std::string &path);
+	void SetSimulationHz(int hz);
+	void SetRenderHz(int hz);
+	void SetPipelined(bool pipelined);
 	void Run();
 	void Setup();
 	void ProcessInput();
-	void Update();
-	void Render();
+	void Update(double deltaTime);
+	void Render(const RenderSnapshot &snapshot);
 	void Cleanup();
 
 	static int WindowWidth;
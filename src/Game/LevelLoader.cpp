@@ -12,6 +12,7 @@
 #include "../Components/HealthComponent.h"
 #include "../Components/TextLabelComponent.h"
 #include "../Components/ScriptComponent.h"
+#include "../Components/ParticleEmitterComponent.h"
 
 class CSVRow
 {
@@ -63,6 +64,7 @@ LevelLoader::LoadLevel(
     sol::state &lua,
     const std::unique_ptr<EntityManager> &entityManager,
     const std::unique_ptr<AssetStore> &assetStore,
+    std::unique_ptr<TilemapLayer> &tilemap,
     SDL_Renderer *renderer,
     const int levelNum
 ) {
@@ -97,7 +99,7 @@ LevelLoader::LoadLevel(
 	}
 
 	if (assetType == "font") {
-	    assetStore->AddFont(assetId, asset["file"], asset["font_size"]);
+	    assetStore->AddFont(renderer, assetId, asset["file"], asset["font_size"]);
 	    Logger::Info("new font asset added");
 	}
 
@@ -114,36 +116,25 @@ LevelLoader::LoadLevel(
 
     std::ifstream file(mapFilePath);
     CSVRow row;
+    std::vector<uint16_t> tiles;
+    tiles.reserve(mapNumCols * mapNumRows);
     int y = 0;
     while(file >> row) {
-        for (int x = 0; x < row.size(); x++) {
-            std::string s = static_cast<std::string>(row[x]);
-
-            Entity tile = entityManager->CreateEntity();
-
-            tile.AddComponent<TransformComponent>(
-                glm::vec2(x * (mapScale * tileSize), y * (mapScale * tileSize)),
-                glm::vec2(mapScale, mapScale),
-                0.0
-            );
-
-            int tilemapX = std::atoi(s.c_str()) % 30;
-            int tilemapY = std::atoi(s.c_str()) / 30;
-            int srcRectX = tilemapX * tileSize;
-            int srcRectY = tilemapY * tileSize;
-
-            std::cout << "map:" << x << ":" << y << std::endl;
-            std::cout << "tilemap-val:" << std::atoi(s.c_str()) << std::endl;
-            std::cout << "tilemap:" << tilemapX << ":" << tilemapY << std::endl;
-            std::cout << srcRectX << ":" << srcRectY << std::endl;
-
-            tile.AddComponent<SpriteComponent>(mapTextureAssetId, tileSize, tileSize, 0, false, srcRectX, srcRectY);
-         }
+        if (y == mapNumRows) {
+            break;
+        }
+        for (int x = 0; x < mapNumCols; x++) {
+            tiles.push_back(x < row.size() ? std::atoi(static_cast<std::string>(row[x]).c_str()) : 0);
+        }
         y++;
     }
+    tiles.resize(mapNumCols * mapNumRows, 0);
 
     file.close();
 
+    tilemap = std::make_unique<TilemapLayer>(mapTextureAssetId, tileSize, mapScale);
+    tilemap->SetTiles(std::move(tiles), mapNumCols, mapNumRows);
+
     Game::MapWidth = mapNumCols * tileSize * mapScale;
     Game::MapHeight = mapNumRows * tileSize * mapScale;
 
@@ -213,7 +204,10 @@ LevelLoader::LoadLevel(
             if (animation != sol::nullopt) {
                 newEntity.AddComponent<AnimationComponent>(
                     entity["components"]["animation"]["num_frames"].get_or(1),
-                    entity["components"]["animation"]["speed_rate"].get_or(1)
+                    entity["components"]["animation"]["speed_rate"].get_or(1),
+                    entity["components"]["animation"]["loop"].get_or(true),
+                    entity["components"]["animation"]["columns"].get_or(0),
+                    entity["components"]["animation"]["event_frame"].get_or(-1)
                 );
             }
 
@@ -225,7 +219,8 @@ LevelLoader::LoadLevel(
                     glm::vec2(
                         entity["components"]["boxcollider"]["offset"]["x"].get_or(0),
                         entity["components"]["boxcollider"]["offset"]["y"].get_or(0)
-                    )
+                    ),
+                    entity["components"]["boxcollider"]["fast"].get_or(false)
                 );
             }
 
@@ -277,6 +272,40 @@ LevelLoader::LoadLevel(
                 );
             }
 
+            sol::optional<sol::table> particleEmitter = entity["components"]["particle_emitter"];
+            if (particleEmitter != sol::nullopt) {
+                sol::table emitter = entity["components"]["particle_emitter"];
+                newEntity.AddComponent<ParticleEmitterComponent>(
+                    emitter["rate"].get_or(0.0f),
+                    emitter["burst"].get_or(0),
+                    glm::vec2(
+                        emitter["offset"]["x"].get_or(0.0f),
+                        emitter["offset"]["y"].get_or(0.0f)
+                    ),
+                    emitter["direction"].get_or(0.0f),
+                    emitter["spread"].get_or(180.0f),
+                    emitter["speed"]["min"].get_or(0.0f),
+                    emitter["speed"]["max"].get_or(0.0f),
+                    emitter["lifetime"]["min"].get_or(1.0f),
+                    emitter["lifetime"]["max"].get_or(1.0f),
+                    emitter["gravity"].get_or(0.0f),
+                    emitter["size"]["start"].get_or(2.0f),
+                    emitter["size"]["end"].get_or(2.0f),
+                    SDL_Color{
+                        emitter["start_color"]["r"].get_or<Uint8>(255),
+                        emitter["start_color"]["g"].get_or<Uint8>(255),
+                        emitter["start_color"]["b"].get_or<Uint8>(255),
+                        emitter["start_color"]["a"].get_or<Uint8>(255)
+                    },
+                    SDL_Color{
+                        emitter["end_color"]["r"].get_or<Uint8>(255),
+                        emitter["end_color"]["g"].get_or<Uint8>(255),
+                        emitter["end_color"]["b"].get_or<Uint8>(255),
+                        emitter["end_color"]["a"].get_or<Uint8>(0)
+                    }
+                );
+            }
+
             sol::optional<sol::table> script = entity["components"]["on_update_script"];
             if (script != sol::nullopt) {
                 sol::function func = entity["components"]["on_update_script"][0];
@@ -6,6 +6,7 @@
 #include <sol/sol.hpp>
 #include "../ECS/ECS.h"
 #include "../AssetStore/AssetStore.h"
+#include "../Renderer/TilemapLayer.h"
 
 class LevelLoader {
 public:
@@ -16,6 +17,7 @@ public:
 		sol::state &lua,
 		const std::unique_ptr<EntityManager> &entityManager,
 		const std::unique_ptr<AssetStore> &assetStore,
+		std::unique_ptr<TilemapLayer> &tilemap,
 		SDL_Renderer *renderer,
 		const int level
 	);
@@ -0,0 +1,100 @@
+#include "ThreadPool.h"
+#include "../Logger/Logger.h"
+
+ThreadPool::ThreadPool(size_t numThreads) {
+	jobFunc = nullptr;
+	jobContext = nullptr;
+	jobCount = 0;
+	jobGeneration = 0;
+	numBusy = 0;
+	isStopping = false;
+
+	for (size_t i = 1; i < numThreads; i++) {
+		workers.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+
+	Logger::Info("thread pool started with " + std::to_string(NumThreads()) + " threads");
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isStopping = true;
+	}
+	jobReady.notify_all();
+
+	for (auto &worker: workers) {
+		worker.join();
+	}
+}
+
+size_t ThreadPool::NumThreads() const {
+	return workers.size() + 1;
+}
+
+void ThreadPool::GetRange(size_t count, size_t threadIdx, size_t &begin, size_t &end) const {
+	const size_t numThreads = NumThreads();
+	begin = count * threadIdx / numThreads;
+	end = count * (threadIdx + 1) / numThreads;
+}
+
+void ThreadPool::workerLoop(size_t threadIdx) {
+	uint64_t lastGeneration = 0;
+
+	while (true) {
+		JobFunc func;
+		void *context;
+		size_t count;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobReady.wait(lock, [&]() { return isStopping || jobGeneration != lastGeneration; });
+			if (isStopping) {
+				return;
+			}
+			lastGeneration = jobGeneration;
+			func = jobFunc;
+			context = jobContext;
+			count = jobCount;
+		}
+
+		size_t begin, end;
+		GetRange(count, threadIdx, begin, end);
+		if (begin < end) {
+			func(context, begin, end, threadIdx);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			numBusy--;
+			if (numBusy == 0) {
+				jobDone.notify_one();
+			}
+		}
+	}
+}
+
+void ThreadPool::run(JobFunc func, void *context, size_t count) {
+	if (workers.empty() || count < 2) {
+		func(context, 0, count, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobFunc = func;
+		jobContext = context;
+		jobCount = count;
+		numBusy = workers.size();
+		jobGeneration++;
+	}
+	jobReady.notify_all();
+
+	size_t begin, end;
+	GetRange(count, 0, begin, end);
+	if (begin < end) {
+		func(context, begin, end, 0);
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+	jobDone.wait(lock, [&]() { return numBusy == 0; });
+}
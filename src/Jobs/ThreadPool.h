@@ -0,0 +1,50 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <type_traits>
+
+// Fork-join pool: ParallelFor splits [0, count) into one contiguous range per thread, with the caller running
+// range 0 itself. Ranges are fixed per thread index, so per-thread outputs can be merged in a stable order.
+class ThreadPool {
+private:
+	typedef void (*JobFunc)(void *context, size_t begin, size_t end, size_t threadIdx);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::condition_variable jobDone;
+
+	JobFunc jobFunc;
+	void *jobContext;
+	size_t jobCount;
+	uint64_t jobGeneration;
+	size_t numBusy;
+	bool isStopping;
+
+	void workerLoop(size_t threadIdx);
+	void run(JobFunc func, void *context, size_t count);
+
+public:
+	ThreadPool(size_t numThreads = std::thread::hardware_concurrency());
+	~ThreadPool();
+
+	size_t NumThreads() const;
+	void GetRange(size_t count, size_t threadIdx, size_t &begin, size_t &end) const;
+
+	template <typename TFunc> void ParallelFor(size_t count, TFunc &&func);
+};
+
+template <typename TFunc>
+void ThreadPool::ParallelFor(size_t count, TFunc &&func) {
+	typedef std::remove_reference_t<TFunc> TFuncType;
+	run([](void *context, size_t begin, size_t end, size_t threadIdx) {
+		(*static_cast<TFuncType*>(context))(begin, end, threadIdx);
+	}, const_cast<void*>(static_cast<const void*>(&func)), count);
+}
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,60 @@
+#include "Worker.h"
+
+Worker::Worker() {
+	jobFunc = nullptr;
+	jobContext = nullptr;
+	isBusy = false;
+	isStopping = false;
+
+	thread = std::thread(&Worker::loop, this);
+}
+
+Worker::~Worker() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isStopping = true;
+	}
+	jobReady.notify_one();
+	thread.join();
+}
+
+void Worker::loop() {
+	while (true) {
+		JobFunc func;
+		void *context;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobReady.wait(lock, [&]() { return isStopping || jobFunc != nullptr; });
+			if (jobFunc == nullptr) {
+				return;
+			}
+			func = jobFunc;
+			context = jobContext;
+			jobFunc = nullptr;
+		}
+
+		func(context);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			isBusy = false;
+		}
+		jobDone.notify_one();
+	}
+}
+
+void Worker::start(JobFunc func, void *context) {
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobFunc = func;
+		jobContext = context;
+		isBusy = true;
+	}
+	jobReady.notify_one();
+}
+
+void Worker::Wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	jobDone.wait(lock, [&]() { return !isBusy; });
+}
@@ -0,0 +1,43 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// A single thread that runs one job at a time alongside the caller, for work that overlaps with the caller's
+// instead of being split with it like ThreadPool::ParallelFor. Start hands the job over and returns straight
+// away; Wait blocks until it's done. The job is called by reference, so it has to outlive the Wait.
+class Worker {
+private:
+	typedef void (*JobFunc)(void *context);
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::condition_variable jobDone;
+
+	JobFunc jobFunc;
+	void *jobContext;
+	bool isBusy;
+	bool isStopping;
+
+	void loop();
+	void start(JobFunc func, void *context);
+
+public:
+	Worker();
+	~Worker();
+
+	template <typename TFunc> void Start(TFunc &func);
+	void Wait();
+};
+
+template <typename TFunc>
+void Worker::Start(TFunc &func) {
+	start([](void *context) {
+		(*static_cast<TFunc*>(context))();
+	}, static_cast<void*>(&func));
+}
+
+#endif // WORKER_H
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <iomanip>
+#include <mutex>
 #include "Logger.h"
 
 bool Logger::Log = false;
@@ -14,6 +15,9 @@ const std::string typeStrs[] = {"INFO", "WARN", "ERR"};
 
 std::vector<LogEntry> Logger::messages;
 
+// The simulation and render threads both log.
+std::mutex logMutex;
+
 void printMessage(enum LogType type, std::string message, const char* colour) {
     std::time_t t = std::time(nullptr);
     std::tm tm = *std::localtime(&t);
@@ -27,6 +31,7 @@ void record(enum LogType type, std::string message, const char* colour) {
 	.type = type,
 	.message = message
     };
+    std::lock_guard<std::mutex> lock(logMutex);
     Logger::messages.push_back(logEntry);
 
     if (Logger::Log) printMessage(type, message, colour);
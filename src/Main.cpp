@@ -1,14 +1,41 @@
 #include <cstring>
+#include <cstdlib>
 #include <iostream>
 #include "./Game/Game.h"
 
+// Usage: gameengine [debug|release] [--record file] [--replay file] [--atlas prefix] [--atlas-out prefix]
+//                   [--headless] [--frames n] [--stats file] [--sim-hz n] [--render-hz n]
+//                   [--pipeline]
 int main(int argc, char* argv[]) {
 	bool debug = true;
 
 	Game game;
 
-	if (argc >= 2)
-		debug = std::strcmp(argv[1], "debug") == 0;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+			game.SetRecordPath(argv[++i]);
+		} else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			game.SetReplayPath(argv[++i]);
+		} else if (std::strcmp(argv[i], "--atlas") == 0 && i + 1 < argc) {
+			game.SetAtlasPath(argv[++i]);
+		} else if (std::strcmp(argv[i], "--atlas-out") == 0 && i + 1 < argc) {
+			game.SetAtlasOutPath(argv[++i]);
+		} else if (std::strcmp(argv[i], "--headless") == 0) {
+			game.SetHeadless(true);
+		} else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			game.SetMaxFrames(std::strtoul(argv[++i], nullptr, 10));
+		} else if (std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+			game.SetStatsPath(argv[++i]);
+		} else if (std::strcmp(argv[i], "--sim-hz") == 0 && i + 1 < argc) {
+			game.SetSimulationHz(std::atoi(argv[++i]));
+		} else if (std::strcmp(argv[i], "--render-hz") == 0 && i + 1 < argc) {
+			game.SetRenderHz(std::atoi(argv[++i]));
+		} else if (std::strcmp(argv[i], "--pipeline") == 0) {
+			game.SetPipelined(true);
+		} else {
+			debug = std::strcmp(argv[i], "debug") == 0;
+		}
+	}
 
 	game.Init(debug);
 	game.Run();
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include "ParticleBuffer.h"
+
+#if defined(__SSE2__)
+#define PARTICLE_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+
+ParticleBuffer::ParticleBuffer(size_t capacity) {
+	const size_t paddedCapacity = (std::max<size_t>(capacity, 1) + 3) / 4 * 4;
+	for (auto array: {&posX, &posY, &velX, &velY, &gravity, &life, &size, &sizeRate, &r, &g, &b, &a, &rRate, &gRate, &bRate, &aRate}) {
+		array->assign(paddedCapacity, 0.0f);
+	}
+}
+
+size_t ParticleBuffer::Capacity() const {
+	return posX.size();
+}
+
+bool ParticleBuffer::Add(const ParticleSpawn &spawn) {
+	if (count == Capacity() || spawn.lifetime <= 0.0f) {
+		return false;
+	}
+
+	const size_t i = count++;
+	posX[i] = spawn.position.x;
+	posY[i] = spawn.position.y;
+	velX[i] = spawn.velocity.x;
+	velY[i] = spawn.velocity.y;
+	gravity[i] = spawn.gravity;
+	life[i] = spawn.lifetime;
+	size[i] = spawn.startSize;
+	sizeRate[i] = (spawn.endSize - spawn.startSize) / spawn.lifetime;
+	r[i] = spawn.startColor.r;
+	g[i] = spawn.startColor.g;
+	b[i] = spawn.startColor.b;
+	a[i] = spawn.startColor.a;
+	rRate[i] = (spawn.endColor.r - spawn.startColor.r) / spawn.lifetime;
+	gRate[i] = (spawn.endColor.g - spawn.startColor.g) / spawn.lifetime;
+	bRate[i] = (spawn.endColor.b - spawn.startColor.b) / spawn.lifetime;
+	aRate[i] = (spawn.endColor.a - spawn.startColor.a) / spawn.lifetime;
+	return true;
+}
+
+void ParticleBuffer::remove(size_t idx) {
+	const size_t last = --count;
+	for (auto array: {&posX, &posY, &velX, &velY, &gravity, &life, &size, &sizeRate, &r, &g, &b, &a, &rRate, &gRate, &bRate, &aRate}) {
+		(*array)[idx] = (*array)[last];
+	}
+}
+
+void ParticleBuffer::Update(float deltaTime) {
+	IntegrateParticles(*this, (count + 3) / 4 * 4, deltaTime);
+
+	for (size_t i = 0; i < count;) {
+		if (life[i] <= 0.0f) {
+			remove(i);
+		} else {
+			i++;
+		}
+	}
+}
+
+void ParticleBuffer::Clear() {
+	count = 0;
+}
+
+void IntegrateParticlesScalar(ParticleBuffer &buffer, size_t count, float deltaTime) {
+	for (size_t i = 0; i < count; i++) {
+		buffer.velY[i] += buffer.gravity[i] * deltaTime;
+		buffer.posX[i] += buffer.velX[i] * deltaTime;
+		buffer.posY[i] += buffer.velY[i] * deltaTime;
+		buffer.life[i] -= deltaTime;
+		buffer.size[i] += buffer.sizeRate[i] * deltaTime;
+		buffer.r[i] += buffer.rRate[i] * deltaTime;
+		buffer.g[i] += buffer.gRate[i] * deltaTime;
+		buffer.b[i] += buffer.bRate[i] * deltaTime;
+		buffer.a[i] += buffer.aRate[i] * deltaTime;
+	}
+}
+
+#ifdef PARTICLE_KERNEL_SSE2
+
+// value[i] += rate[i] * dt for 4 particles.
+static inline void integrate4(float *value, const float *rate, __m128 dt) {
+	_mm_storeu_ps(value, _mm_add_ps(_mm_loadu_ps(value), _mm_mul_ps(_mm_loadu_ps(rate), dt)));
+}
+
+void IntegrateParticlesSSE2(ParticleBuffer &buffer, size_t count, float deltaTime) {
+	const __m128 dt = _mm_set1_ps(deltaTime);
+
+	for (size_t i = 0; i < count; i += 4) {
+		integrate4(&buffer.velY[i], &buffer.gravity[i], dt);
+		integrate4(&buffer.posX[i], &buffer.velX[i], dt);
+		integrate4(&buffer.posY[i], &buffer.velY[i], dt);
+		_mm_storeu_ps(&buffer.life[i], _mm_sub_ps(_mm_loadu_ps(&buffer.life[i]), dt));
+		integrate4(&buffer.size[i], &buffer.sizeRate[i], dt);
+		integrate4(&buffer.r[i], &buffer.rRate[i], dt);
+		integrate4(&buffer.g[i], &buffer.gRate[i], dt);
+		integrate4(&buffer.b[i], &buffer.bRate[i], dt);
+		integrate4(&buffer.a[i], &buffer.aRate[i], dt);
+	}
+}
+
+#else
+
+void IntegrateParticlesSSE2(ParticleBuffer &buffer, size_t count, float deltaTime) {
+	IntegrateParticlesScalar(buffer, count, deltaTime);
+}
+
+#endif
+
+void IntegrateParticles(ParticleBuffer &buffer, size_t count, float deltaTime) {
+#ifdef PARTICLE_KERNEL_SSE2
+	IntegrateParticlesSSE2(buffer, count, deltaTime);
+#else
+	IntegrateParticlesScalar(buffer, count, deltaTime);
+#endif
+}
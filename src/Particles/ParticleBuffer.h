@@ -0,0 +1,65 @@
+#ifndef PARTICLE_BUFFER_H
+#define PARTICLE_BUFFER_H
+
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <SDL2/SDL.h>
+
+struct ParticleSpawn {
+	glm::vec2 position;
+	glm::vec2 velocity;
+	float gravity;
+	float lifetime;
+	float startSize;
+	float endSize;
+	SDL_Color startColor;
+	SDL_Color endColor;
+};
+
+// Live particles stored as structure-of-arrays, so the integration kernels can work on 4 particles at a time.
+// Size and colour change linearly over a particle's life, so they're stored with a rate of change and integrated
+// like the position. Dead particles are removed by moving the last particle into their slot, so the order of
+// particles isn't kept.
+//
+// The arrays are allocated once, rounded up to a multiple of 4, and the kernels run over the padding past the
+// last particle rather than a scalar tail.
+struct ParticleBuffer {
+	std::vector<float> posX;
+	std::vector<float> posY;
+	std::vector<float> velX;
+	std::vector<float> velY;
+	std::vector<float> gravity;
+	std::vector<float> life;
+	std::vector<float> size;
+	std::vector<float> sizeRate;
+	std::vector<float> r;
+	std::vector<float> g;
+	std::vector<float> b;
+	std::vector<float> a;
+	std::vector<float> rRate;
+	std::vector<float> gRate;
+	std::vector<float> bRate;
+	std::vector<float> aRate;
+	size_t count = 0;
+
+	ParticleBuffer(size_t capacity);
+
+	size_t Capacity() const;
+	// Returns false when the buffer is full and the particle was dropped.
+	bool Add(const ParticleSpawn &spawn);
+	// Moves every particle on by deltaTime seconds and removes the ones that died.
+	void Update(float deltaTime);
+	void Clear();
+
+private:
+	void remove(size_t idx);
+};
+
+// Each kernel integrates the particles in [0, count) over deltaTime; count is rounded up to a multiple of 4.
+void IntegrateParticlesScalar(ParticleBuffer &buffer, size_t count, float deltaTime);
+void IntegrateParticlesSSE2(ParticleBuffer &buffer, size_t count, float deltaTime);
+// Uses SSE2 where it's available.
+void IntegrateParticles(ParticleBuffer &buffer, size_t count, float deltaTime);
+
+#endif // PARTICLE_BUFFER_H
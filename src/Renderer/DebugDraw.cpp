@@ -0,0 +1,136 @@
+#include <cmath>
+#include <algorithm>
+#include "DebugDraw.h"
+#include "../Logger/Logger.h"
+
+DebugDraw::DebugDraw() {
+	numDrawCalls = 0;
+}
+
+DebugDraw::RectBatch &DebugDraw::rectBatch(SDL_Color color) {
+	for (auto &batch: rectBatches) {
+		if (batch.color.r == color.r && batch.color.g == color.g && batch.color.b == color.b && batch.color.a == color.a) {
+			return batch;
+		}
+	}
+	rectBatches.push_back({color, {}, {}});
+	return rectBatches.back();
+}
+
+void DebugDraw::addVertex(const glm::vec2 &position, SDL_Color color) {
+	SDL_Vertex vertex;
+	vertex.position.x = position.x;
+	vertex.position.y = position.y;
+	vertex.color = color;
+	vertex.tex_coord.x = 0.0f;
+	vertex.tex_coord.y = 0.0f;
+	vertices.push_back(vertex);
+}
+
+void DebugDraw::addQuad(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c, const glm::vec2 &d, SDL_Color color) {
+	const int firstVertex = static_cast<int>(vertices.size());
+	addVertex(a, color);
+	addVertex(b, color);
+	addVertex(c, color);
+	addVertex(d, color);
+
+	const int quadIndices[6] = {0, 1, 2, 0, 2, 3};
+	for (int i = 0; i < 6; i++) {
+		indices.push_back(firstVertex + quadIndices[i]);
+	}
+}
+
+// Keeps the segments a few pixels long whatever the radius.
+int DebugDraw::numCircleSegments(float radius) {
+	return std::clamp(static_cast<int>(radius / 2.0f), 12, 64);
+}
+
+void DebugDraw::DrawRect(const SDL_Rect &rect, SDL_Color color) {
+	rectBatch(color).outlined.push_back(rect);
+}
+
+void DebugDraw::FillRect(const SDL_Rect &rect, SDL_Color color) {
+	rectBatch(color).filled.push_back(rect);
+}
+
+// The line is a quad thickness pixels wide, centred on the segment.
+void DebugDraw::DrawLine(const glm::vec2 &from, const glm::vec2 &to, SDL_Color color, float thickness) {
+	const glm::vec2 direction = to - from;
+	const float length = glm::length(direction);
+	if (length <= 0.0f) {
+		return;
+	}
+	const glm::vec2 normal = glm::vec2(-direction.y, direction.x) * (thickness / 2.0f / length);
+	addQuad(from + normal, to + normal, to - normal, from - normal, color);
+}
+
+// The outline is a ring of quads between radius - thickness / 2 and radius + thickness / 2.
+void DebugDraw::DrawCircle(const glm::vec2 &centre, float radius, SDL_Color color, float thickness) {
+	const int numSegments = numCircleSegments(radius);
+	const float innerRadius = std::max(radius - thickness / 2.0f, 0.0f);
+	const float outerRadius = radius + thickness / 2.0f;
+
+	const int firstVertex = static_cast<int>(vertices.size());
+	for (int i = 0; i < numSegments; i++) {
+		const float angle = 2.0f * static_cast<float>(M_PI) * i / numSegments;
+		const glm::vec2 direction(std::cos(angle), std::sin(angle));
+		addVertex(centre + direction * innerRadius, color);
+		addVertex(centre + direction * outerRadius, color);
+	}
+	for (int i = 0; i < numSegments; i++) {
+		const int inner = firstVertex + i * 2;
+		const int nextInner = firstVertex + ((i + 1) % numSegments) * 2;
+		const int quadIndices[6] = {inner, inner + 1, nextInner + 1, inner, nextInner + 1, nextInner};
+		indices.insert(indices.end(), quadIndices, quadIndices + 6);
+	}
+}
+
+void DebugDraw::FillCircle(const glm::vec2 &centre, float radius, SDL_Color color) {
+	const int numSegments = numCircleSegments(radius);
+
+	const int centreVertex = static_cast<int>(vertices.size());
+	addVertex(centre, color);
+	for (int i = 0; i < numSegments; i++) {
+		const float angle = 2.0f * static_cast<float>(M_PI) * i / numSegments;
+		addVertex(centre + glm::vec2(std::cos(angle), std::sin(angle)) * radius, color);
+	}
+	for (int i = 0; i < numSegments; i++) {
+		indices.push_back(centreVertex);
+		indices.push_back(centreVertex + 1 + i);
+		indices.push_back(centreVertex + 1 + (i + 1) % numSegments);
+	}
+}
+
+void DebugDraw::Flush(SDL_Renderer *renderer) {
+	numDrawCalls = 0;
+
+	for (auto &batch: rectBatches) {
+		if (batch.filled.empty() && batch.outlined.empty()) {
+			continue;
+		}
+		SDL_SetRenderDrawColor(renderer, batch.color.r, batch.color.g, batch.color.b, batch.color.a);
+		if (!batch.filled.empty()) {
+			SDL_RenderFillRects(renderer, batch.filled.data(), static_cast<int>(batch.filled.size()));
+			numDrawCalls++;
+		}
+		if (!batch.outlined.empty()) {
+			SDL_RenderDrawRects(renderer, batch.outlined.data(), static_cast<int>(batch.outlined.size()));
+			numDrawCalls++;
+		}
+		batch.filled.clear();
+		batch.outlined.clear();
+	}
+
+	if (!indices.empty()) {
+		if (SDL_RenderGeometry(renderer, NULL, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size())) != 0) {
+			Logger::Err(std::string("error drawing debug shapes: ") + SDL_GetError());
+		}
+		numDrawCalls++;
+		vertices.clear();
+		indices.clear();
+	}
+}
+
+size_t DebugDraw::GetNumDrawCalls() const {
+	return numDrawCalls;
+}
@@ -0,0 +1,46 @@
+#ifndef DEBUG_DRAW_H
+#define DEBUG_DRAW_H
+
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <SDL2/SDL.h>
+
+// Collects debug shapes over a frame and draws them together in Flush. Rectangles are grouped by colour, with one
+// SDL_RenderDrawRects and one SDL_RenderFillRects call per colour. Lines and circles are built into quads and
+// triangles with the colour in the vertices, so all of them go out in a single SDL_RenderGeometry call.
+// Rectangles are drawn before lines and circles.
+class DebugDraw {
+private:
+	struct RectBatch {
+		SDL_Color color;
+		std::vector<SDL_Rect> filled;
+		std::vector<SDL_Rect> outlined;
+	};
+
+	std::vector<RectBatch> rectBatches;
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
+	size_t numDrawCalls;
+
+	RectBatch &rectBatch(SDL_Color color);
+	void addVertex(const glm::vec2 &position, SDL_Color color);
+	void addQuad(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c, const glm::vec2 &d, SDL_Color color);
+	static int numCircleSegments(float radius);
+
+public:
+	DebugDraw();
+
+	void DrawRect(const SDL_Rect &rect, SDL_Color color);
+	void FillRect(const SDL_Rect &rect, SDL_Color color);
+	void DrawLine(const glm::vec2 &from, const glm::vec2 &to, SDL_Color color, float thickness = 1.0f);
+	void DrawCircle(const glm::vec2 &centre, float radius, SDL_Color color, float thickness = 1.0f);
+	void FillCircle(const glm::vec2 &centre, float radius, SDL_Color color);
+
+	void Flush(SDL_Renderer *renderer);
+
+	// Draw calls made by the last Flush.
+	size_t GetNumDrawCalls() const;
+};
+
+#endif // DEBUG_DRAW_H
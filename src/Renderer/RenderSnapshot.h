@@ -0,0 +1,81 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <SDL2/SDL.h>
+#include "SpriteVertexBuffer.h"
+
+// World positions are kept for both the previous and the current simulation step; the frame is drawn between
+// them at the snapshot's alpha. Health bar positions are the top right corner of the sprite, where the bar is drawn.
+struct HealthBarSnapshot {
+	glm::vec2 previousPosition;
+	glm::vec2 position;
+	int healthPercentage;
+};
+
+struct TextLabelSnapshot {
+	size_t entityId;
+	glm::vec2 position;
+	std::string text;
+	std::string assetId;
+	SDL_Color color;
+	bool isFixed;
+	bool isCached;
+};
+
+struct ColliderSnapshot {
+	glm::vec2 previousPosition;
+	glm::vec2 position;
+	glm::vec2 size;
+	SDL_Color colour;
+};
+
+// Particles are drawn where they were at the end of the step, without interpolation; they're short lived and
+// there are too many to keep a previous position for.
+struct ParticleSnapshot {
+	float x;
+	float y;
+	float size;
+	SDL_Color color;
+};
+
+// Everything the render systems draw, copied out of the registry once the simulation steps of a frame are done.
+// Drawing only reads a snapshot, so the next frame can be simulated into another one at the same time.
+struct RenderSnapshot {
+	uint32_t frame = 0;
+	float alpha = 1.0f;
+	SDL_Rect previousCamera = {0, 0, 0, 0};
+	SDL_Rect camera = {0, 0, 0, 0};
+
+	// Sprite quads are built when the snapshot is extracted, already interpolated and in draw order.
+	SpriteVertexBuffer sprites;
+	std::vector<HealthBarSnapshot> healthBars;
+	std::vector<TextLabelSnapshot> textLabels;
+	std::vector<ColliderSnapshot> colliders;
+	std::vector<ParticleSnapshot> particles;
+
+	void Clear() {
+		sprites.Clear();
+		healthBars.clear();
+		textLabels.clear();
+		colliders.clear();
+		particles.clear();
+	}
+
+	SDL_Rect InterpolatedCamera() const {
+		SDL_Rect rect = camera;
+		rect.x = static_cast<int>(std::round(previousCamera.x + (camera.x - previousCamera.x) * alpha));
+		rect.y = static_cast<int>(std::round(previousCamera.y + (camera.y - previousCamera.y) * alpha));
+		return rect;
+	}
+
+	glm::vec2 Interpolate(const glm::vec2 &previous, const glm::vec2 &current) const {
+		return previous + (current - previous) * alpha;
+	}
+};
+
+#endif // RENDER_SNAPSHOT_H
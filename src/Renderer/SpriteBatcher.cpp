@@ -0,0 +1,29 @@
+#include <string>
+#include "SpriteBatcher.h"
+#include "../Logger/Logger.h"
+
+void SpriteBatcher::Draw(SDL_Renderer *renderer, const SpriteVertexBuffer &buffer) {
+	stats.numSprites = buffer.NumSprites();
+	stats.numDrawCalls = 0;
+
+	for (const auto &run: buffer.runs) {
+		const size_t numQuads = run.numVertices / 4;
+		if (indices.size() < numQuads * 6) {
+			const int quadIndices[6] = {0, 1, 2, 0, 2, 3};
+			for (size_t quad = indices.size() / 6; quad < numQuads; quad++) {
+				for (int i = 0; i < 6; i++) {
+					indices.push_back(static_cast<int>(quad * 4) + quadIndices[i]);
+				}
+			}
+		}
+
+		if (SDL_RenderGeometry(renderer, run.texture, buffer.vertices.data() + run.firstVertex, static_cast<int>(run.numVertices), indices.data(), static_cast<int>(numQuads * 6)) != 0) {
+			Logger::Err(std::string("error drawing sprite batch: ") + SDL_GetError());
+		}
+		stats.numDrawCalls++;
+	}
+}
+
+const SpriteBatchStats &SpriteBatcher::GetStats() const {
+	return stats;
+}
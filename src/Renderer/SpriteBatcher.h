@@ -0,0 +1,29 @@
+#ifndef SPRITE_BATCHER_H
+#define SPRITE_BATCHER_H
+
+#include <vector>
+#include <cstddef>
+#include <SDL2/SDL.h>
+#include "SpriteVertexBuffer.h"
+
+struct SpriteBatchStats {
+	size_t numSprites = 0;
+	size_t numDrawCalls = 0;
+};
+
+// Submits a SpriteVertexBuffer with one SDL_RenderGeometry call per run. All the runs share one index buffer,
+// which only grows when a run is longer than any before it.
+class SpriteBatcher {
+private:
+	std::vector<int> indices;
+	SpriteBatchStats stats;
+
+public:
+	SpriteBatcher() = default;
+
+	void Draw(SDL_Renderer *renderer, const SpriteVertexBuffer &buffer);
+
+	const SpriteBatchStats &GetStats() const;
+};
+
+#endif // SPRITE_BATCHER_H
@@ -0,0 +1,82 @@
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "SpriteVertexBuffer.h"
+
+void SpriteVertexBuffer::Clear() {
+	vertices.clear();
+	runs.clear();
+}
+
+size_t SpriteVertexBuffer::NumSprites() const {
+	return vertices.size() / 4;
+}
+
+void SpriteVertexBuffer::AddQuad(SDL_Texture *texture, int zIndex, float textureWidth, float textureHeight, const SDL_Rect &srcRect, const SDL_FRect &dstRect, float rotation, SDL_RendererFlip flip) {
+	if (!texture) {
+		return;
+	}
+
+	float u0 = srcRect.x / textureWidth;
+	float v0 = srcRect.y / textureHeight;
+	float u1 = (srcRect.x + srcRect.w) / textureWidth;
+	float v1 = (srcRect.y + srcRect.h) / textureHeight;
+	if (flip & SDL_FLIP_HORIZONTAL) {
+		std::swap(u0, u1);
+	}
+	if (flip & SDL_FLIP_VERTICAL) {
+		std::swap(v0, v1);
+	}
+
+	const float halfWidth = dstRect.w / 2;
+	const float halfHeight = dstRect.h / 2;
+	const glm::vec2 centre(dstRect.x + halfWidth, dstRect.y + halfHeight);
+	const glm::vec2 corners[4] = {
+		{-halfWidth, -halfHeight},
+		{halfWidth, -halfHeight},
+		{halfWidth, halfHeight},
+		{-halfWidth, halfHeight}
+	};
+	const float uvs[4][2] = {{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}};
+
+	// Rotation is clockwise in degrees, as y points down the screen.
+	float cosAngle = 1.0f;
+	float sinAngle = 0.0f;
+	if (rotation != 0) {
+		const float radians = glm::radians(rotation);
+		cosAngle = std::cos(radians);
+		sinAngle = std::sin(radians);
+	}
+
+	const SpriteRun run = {zIndex, texture, static_cast<uint32_t>(vertices.size()), 4};
+	if (!runs.empty() && runs.back().SharesBatch(run)) {
+		runs.back().numVertices += 4;
+	} else {
+		runs.push_back(run);
+	}
+
+	for (int i = 0; i < 4; i++) {
+		SDL_Vertex vertex;
+		vertex.position.x = centre.x + corners[i].x * cosAngle - corners[i].y * sinAngle;
+		vertex.position.y = centre.y + corners[i].x * sinAngle + corners[i].y * cosAngle;
+		vertex.color = {255, 255, 255, 255};
+		vertex.tex_coord.x = uvs[i][0];
+		vertex.tex_coord.y = uvs[i][1];
+		vertices.push_back(vertex);
+	}
+}
+
+void SpriteVertexBuffer::AppendRun(const SpriteVertexBuffer &source, const SpriteRun &run) {
+	if (!runs.empty() && runs.back().SharesBatch(run)) {
+		runs.back().numVertices += run.numVertices;
+	} else {
+		runs.push_back({run.zIndex, run.texture, static_cast<uint32_t>(vertices.size()), run.numVertices});
+	}
+	vertices.insert(vertices.end(), source.vertices.begin() + run.firstVertex, source.vertices.begin() + run.firstVertex + run.numVertices);
+}
+
+void SpriteVertexBuffer::Append(const SpriteVertexBuffer &source) {
+	for (const auto &run: source.runs) {
+		AppendRun(source, run);
+	}
+}
@@ -0,0 +1,41 @@
+#ifndef SPRITE_VERTEX_BUFFER_H
+#define SPRITE_VERTEX_BUFFER_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <SDL2/SDL.h>
+
+// Quads that share a texture and z index and are drawn with one SDL_RenderGeometry call.
+struct SpriteRun {
+	int zIndex;
+	SDL_Texture *texture;
+	uint32_t firstVertex;
+	uint32_t numVertices;
+
+	bool DrawsBefore(const SpriteRun &other) const {
+		return zIndex != other.zIndex ? zIndex < other.zIndex : texture < other.texture;
+	}
+
+	bool SharesBatch(const SpriteRun &other) const {
+		return zIndex == other.zIndex && texture == other.texture;
+	}
+};
+
+// Sprite quads in draw order, with four vertices per sprite. Building quads doesn't touch the renderer, so several
+// threads can each fill their own buffer and the buffers can be appended together afterwards. Flipping and
+// rotation (around the centre, like SDL_RenderCopyEx) are applied to the vertices.
+struct SpriteVertexBuffer {
+	std::vector<SDL_Vertex> vertices;
+	std::vector<SpriteRun> runs;
+
+	void Clear();
+	size_t NumSprites() const;
+	// textureWidth and textureHeight are the size of the whole texture, to work out the texture coordinates.
+	void AddQuad(SDL_Texture *texture, int zIndex, float textureWidth, float textureHeight, const SDL_Rect &srcRect, const SDL_FRect &dstRect, float rotation, SDL_RendererFlip flip);
+	// Copies the quads of one of source's runs to the end of this buffer.
+	void AppendRun(const SpriteVertexBuffer &source, const SpriteRun &run);
+	void Append(const SpriteVertexBuffer &source);
+};
+
+#endif // SPRITE_VERTEX_BUFFER_H
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include "TextBatcher.h"
+#include "../Logger/Logger.h"
+
+TextBatcher::TextBatcher() {
+	renderer = nullptr;
+	texture = nullptr;
+	textureWidth = 1.0f;
+	textureHeight = 1.0f;
+	numDrawCalls = 0;
+}
+
+void TextBatcher::Begin(SDL_Renderer *renderer) {
+	this->renderer = renderer;
+	texture = nullptr;
+	vertices.clear();
+	indices.clear();
+	numDrawCalls = 0;
+}
+
+void TextBatcher::Flush() {
+	if (indices.empty()) {
+		return;
+	}
+	if (SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size())) != 0) {
+		Logger::Err(std::string("error drawing text batch: ") + SDL_GetError());
+	}
+	numDrawCalls++;
+	vertices.clear();
+	indices.clear();
+}
+
+void TextBatcher::Draw(GlyphAtlas &atlas, const std::string &text, float x, float y, SDL_Color color) {
+	if (!atlas.GetTexture()) {
+		return;
+	}
+	if (atlas.GetTexture() != texture) {
+		Flush();
+		texture = atlas.GetTexture();
+		int width, height;
+		SDL_QueryTexture(texture, NULL, NULL, &width, &height);
+		textureWidth = static_cast<float>(std::max(width, 1));
+		textureHeight = static_cast<float>(std::max(height, 1));
+	}
+
+	for (const auto &quad: atlas.Layout(text).quads) {
+		const float left = x + quad.dstRect.x;
+		const float top = y + quad.dstRect.y;
+		const float right = left + quad.dstRect.w;
+		const float bottom = top + quad.dstRect.h;
+		const float u0 = quad.srcRect.x / textureWidth;
+		const float v0 = quad.srcRect.y / textureHeight;
+		const float u1 = (quad.srcRect.x + quad.srcRect.w) / textureWidth;
+		const float v1 = (quad.srcRect.y + quad.srcRect.h) / textureHeight;
+
+		const int firstVertex = static_cast<int>(vertices.size());
+		vertices.push_back({{left, top}, color, {u0, v0}});
+		vertices.push_back({{right, top}, color, {u1, v0}});
+		vertices.push_back({{right, bottom}, color, {u1, v1}});
+		vertices.push_back({{left, bottom}, color, {u0, v1}});
+
+		const int quadIndices[6] = {0, 1, 2, 0, 2, 3};
+		for (int i = 0; i < 6; i++) {
+			indices.push_back(firstVertex + quadIndices[i]);
+		}
+	}
+}
+
+void TextBatcher::End() {
+	Flush();
+}
+
+size_t TextBatcher::GetNumDrawCalls() const {
+	return numDrawCalls;
+}
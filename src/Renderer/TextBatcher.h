@@ -0,0 +1,33 @@
+#ifndef TEXT_BATCHER_H
+#define TEXT_BATCHER_H
+
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include "../AssetStore/GlyphAtlas.h"
+
+// Draws strings as glyph quads from a GlyphAtlas, tinted through the vertex colour. Strings are drawn in the
+// order they're queued, with one SDL_RenderGeometry call for every run of strings sharing an atlas.
+class TextBatcher {
+private:
+	SDL_Renderer *renderer;
+	SDL_Texture *texture;
+	float textureWidth;
+	float textureHeight;
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
+	size_t numDrawCalls;
+
+public:
+	TextBatcher();
+
+	void Begin(SDL_Renderer *renderer);
+	void Draw(GlyphAtlas &atlas, const std::string &text, float x, float y, SDL_Color color);
+	// Draws what has been queued so far, so other drawing can go in between strings.
+	void Flush();
+	void End();
+
+	size_t GetNumDrawCalls() const;
+};
+
+#endif // TEXT_BATCHER_H
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include "TilemapLayer.h"
+#include "../Logger/Logger.h"
+
+TilemapLayer::TilemapLayer(const std::string &tilesetAssetId, int tileSize, float scale) {
+	this->tilesetAssetId = tilesetAssetId;
+	this->tileSize = tileSize;
+	this->scale = scale;
+	numCols = 0;
+	numRows = 0;
+	chunkCols = 0;
+	chunkRows = 0;
+	tileset = nullptr;
+	numDrawCalls = 0;
+}
+
+TilemapLayer::~TilemapLayer() {
+	destroyChunks();
+}
+
+void TilemapLayer::SetTiles(std::vector<uint16_t> tiles, int numCols, int numRows) {
+	this->tiles = std::move(tiles);
+	this->numCols = numCols;
+	this->numRows = numRows;
+	chunkCols = (numCols + CHUNK_TILES - 1) / CHUNK_TILES;
+	chunkRows = (numRows + CHUNK_TILES - 1) / CHUNK_TILES;
+}
+
+SDL_Rect TilemapLayer::tileSrcRect(uint16_t tile) const {
+	const int tilesetCols = std::max(tileset->rect.w / tileSize, 1);
+	return {
+		tileset->rect.x + (tile % tilesetCols) * tileSize,
+		tileset->rect.y + (tile / tilesetCols) * tileSize,
+		tileSize,
+		tileSize
+	};
+}
+
+void TilemapLayer::renderTiles(SDL_Renderer *renderer, const Chunk &chunk, float x, float y, float tileWidth) {
+	for (int row = 0; row < chunk.numRows; row++) {
+		for (int col = 0; col < chunk.numCols; col++) {
+			const uint16_t tile = tiles[(chunk.firstRow + row) * numCols + chunk.firstCol + col];
+			const SDL_Rect srcRect = tileSrcRect(tile);
+			const SDL_FRect dstRect = {x + col * tileWidth, y + row * tileWidth, tileWidth, tileWidth};
+			SDL_RenderCopyF(renderer, tileset->texture, &srcRect, &dstRect);
+		}
+	}
+}
+
+void TilemapLayer::destroyChunks() {
+	for (auto &chunk: chunks) {
+		if (chunk.texture) {
+			SDL_DestroyTexture(chunk.texture);
+		}
+	}
+	chunks.clear();
+}
+
+void TilemapLayer::Build(SDL_Renderer *renderer, std::unique_ptr<AssetStore>& assetStore) {
+	tileset = assetStore->GetTextureRegion(tilesetAssetId);
+	if (!tileset) {
+		Logger::Err("missing tileset texture " + tilesetAssetId);
+		return;
+	}
+	Rebuild(renderer);
+}
+
+void TilemapLayer::Rebuild(SDL_Renderer *renderer) {
+	destroyChunks();
+	if (!tileset) {
+		return;
+	}
+
+	SDL_Texture *previousTarget = SDL_GetRenderTarget(renderer);
+	for (int chunkRow = 0; chunkRow < chunkRows; chunkRow++) {
+		for (int chunkCol = 0; chunkCol < chunkCols; chunkCol++) {
+			Chunk chunk;
+			chunk.firstCol = chunkCol * CHUNK_TILES;
+			chunk.firstRow = chunkRow * CHUNK_TILES;
+			chunk.numCols = std::min(CHUNK_TILES, numCols - chunk.firstCol);
+			chunk.numRows = std::min(CHUNK_TILES, numRows - chunk.firstRow);
+			chunk.texture = SDL_CreateTexture(
+				renderer,
+				SDL_PIXELFORMAT_RGBA32,
+				SDL_TEXTUREACCESS_TARGET,
+				chunk.numCols * tileSize,
+				chunk.numRows * tileSize
+			);
+
+			// Without render targets the chunk's tiles are drawn one by one instead.
+			if (chunk.texture && SDL_SetRenderTarget(renderer, chunk.texture) == 0) {
+				SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
+				SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+				SDL_RenderClear(renderer);
+				renderTiles(renderer, chunk, 0, 0, static_cast<float>(tileSize));
+			} else {
+				Logger::Err("error creating tilemap chunk texture: " + std::string(SDL_GetError()));
+				if (chunk.texture) {
+					SDL_DestroyTexture(chunk.texture);
+					chunk.texture = nullptr;
+				}
+			}
+			chunks.push_back(chunk);
+		}
+	}
+	SDL_SetRenderTarget(renderer, previousTarget);
+}
+
+void TilemapLayer::Draw(SDL_Renderer *renderer, const SDL_Rect &camera) {
+	numDrawCalls = 0;
+	if (chunks.empty()) {
+		return;
+	}
+
+	const float tileWidth = tileSize * scale;
+	const float chunkWidth = CHUNK_TILES * tileWidth;
+	const int firstChunkCol = std::max(static_cast<int>(std::floor(camera.x / chunkWidth)), 0);
+	const int firstChunkRow = std::max(static_cast<int>(std::floor(camera.y / chunkWidth)), 0);
+	const int lastChunkCol = std::min(static_cast<int>(std::floor((camera.x + camera.w) / chunkWidth)), chunkCols - 1);
+	const int lastChunkRow = std::min(static_cast<int>(std::floor((camera.y + camera.h) / chunkWidth)), chunkRows - 1);
+
+	for (int chunkRow = firstChunkRow; chunkRow <= lastChunkRow; chunkRow++) {
+		for (int chunkCol = firstChunkCol; chunkCol <= lastChunkCol; chunkCol++) {
+			const Chunk &chunk = chunks[chunkRow * chunkCols + chunkCol];
+			const float x = chunkCol * chunkWidth - camera.x;
+			const float y = chunkRow * chunkWidth - camera.y;
+			if (chunk.texture) {
+				const SDL_FRect dstRect = {x, y, chunk.numCols * tileWidth, chunk.numRows * tileWidth};
+				SDL_RenderCopyF(renderer, chunk.texture, NULL, &dstRect);
+				numDrawCalls++;
+			} else {
+				renderTiles(renderer, chunk, x, y, tileWidth);
+				numDrawCalls += chunk.numCols * chunk.numRows;
+			}
+		}
+	}
+}
+
+int TilemapLayer::GetWidth() const {
+	return static_cast<int>(numCols * tileSize * scale);
+}
+
+int TilemapLayer::GetHeight() const {
+	return static_cast<int>(numRows * tileSize * scale);
+}
+
+size_t TilemapLayer::GetNumDrawCalls() const {
+	return numDrawCalls;
+}
@@ -0,0 +1,62 @@
+#ifndef TILEMAP_LAYER_H
+#define TILEMAP_LAYER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <SDL2/SDL.h>
+#include "../AssetStore/AssetStore.h"
+
+// Background tiles of a level. Tile indices are kept in one array and the map is pre-rendered into render target
+// textures of CHUNK_TILES x CHUNK_TILES tiles, so drawing the background is one copy per chunk on screen. The
+// chunks have to be rendered again after SDL_RENDER_TARGETS_RESET, see Rebuild.
+class TilemapLayer {
+private:
+	static constexpr int CHUNK_TILES = 16;
+
+	struct Chunk {
+		SDL_Texture *texture;
+		int firstCol;
+		int firstRow;
+		int numCols;
+		int numRows;
+	};
+
+	std::string tilesetAssetId;
+	std::vector<uint16_t> tiles;
+	int numCols;
+	int numRows;
+	int tileSize;
+	float scale;
+
+	int chunkCols;
+	int chunkRows;
+	std::vector<Chunk> chunks;
+	const TextureRegion *tileset;
+	size_t numDrawCalls;
+
+	SDL_Rect tileSrcRect(uint16_t tile) const;
+	void renderTiles(SDL_Renderer *renderer, const Chunk &chunk, float x, float y, float tileWidth);
+	void destroyChunks();
+
+public:
+	TilemapLayer(const std::string &tilesetAssetId, int tileSize, float scale);
+	~TilemapLayer();
+
+	TilemapLayer(const TilemapLayer&) = delete;
+	TilemapLayer &operator =(const TilemapLayer&) = delete;
+
+	// Tile indices are row by row and count tileset tiles left to right, top to bottom.
+	void SetTiles(std::vector<uint16_t> tiles, int numCols, int numRows);
+
+	void Build(SDL_Renderer *renderer, std::unique_ptr<AssetStore>& assetStore);
+	void Rebuild(SDL_Renderer *renderer);
+	void Draw(SDL_Renderer *renderer, const SDL_Rect &camera);
+
+	int GetWidth() const;
+	int GetHeight() const;
+	size_t GetNumDrawCalls() const;
+};
+
+#endif // TILEMAP_LAYER_H
@@ -1,26 +1,230 @@
 #ifndef ANIMATION_SYSTEM_H
 #define ANIMATION_SYSTEM_H
 
+#include <vector>
+#include <limits>
+#include <cstdint>
 #include <SDL2/SDL.h>
 #include "../ECS/ECS.h"
+#include "../EventBus/EventBus.h"
+#include "../Events/AnimationEvent.h"
 #include "../Components/AnimationComponent.h"
 #include "../Components/SpriteComponent.h"
-#include "../AssetStore/AssetStore.h"
 
+#if defined(__SSE2__)
+#define ANIMATION_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+// Each animation is kept in packed arrays with the time its next frame is due. An update scans the deadlines,
+// four at a time with SSE2, and only touches the animations whose frame changes. The clip settings and the sprite
+// layout are copied in when the entity is added. Finished clips stay in the arrays with a deadline that never
+// comes.
 class AnimationSystem : public System {
+private:
+	static constexpr int32_t NEVER = std::numeric_limits<int32_t>::max();
+
+	struct Clip {
+		int32_t startTime;
+		int frameRateSpeed;
+		int numFrames;
+		int numColumns;
+		int eventFrame;
+		bool isLoop;
+		int currentFrame;
+		// Frames shown since the clip started, without wrapping; finished clips stop at their last frame.
+		int frameCount;
+		// The frame count the deadline is for, with its start kept as whole and leftover milliseconds after
+		// startTime: nextCount * 1000 = nextStart * frameRateSpeed + nextRemainder. Stepping on to the frame after
+		// it adds msPerFrame and msRemainder (1000 / frameRateSpeed and 1000 % frameRateSpeed), without dividing.
+		int nextCount;
+		int32_t nextStart;
+		int nextRemainder;
+		int msPerFrame;
+		int msRemainder;
+		// Where the first frame is on the sheet, and the frame size.
+		int originX;
+		int originY;
+		int width;
+		int height;
+	};
+
+	std::vector<int32_t> deadlines;
+	std::vector<Clip> clips;
+	std::vector<Entity> entities;
+	std::vector<size_t> slots;
+	std::vector<uint32_t> due;
+
+	// Frame k of a clip starts at startTime + k * 1000 / frameRateSpeed ms, rounded up to match the frame that
+	// frameAt works out.
+	static int32_t nextStartTime(const Clip &clip) {
+		return clip.startTime + clip.nextStart + (clip.nextRemainder > 0 ? 1 : 0);
+	}
+
+	static void setNextFrame(Clip &clip, int frameCount) {
+		const int64_t total = static_cast<int64_t>(frameCount) * 1000;
+		clip.nextCount = frameCount;
+		clip.nextStart = static_cast<int32_t>(total / clip.frameRateSpeed);
+		clip.nextRemainder = static_cast<int>(total % clip.frameRateSpeed);
+	}
+
+	static void stepNextFrame(Clip &clip) {
+		clip.nextCount++;
+		clip.nextStart += clip.msPerFrame;
+		clip.nextRemainder += clip.msRemainder;
+		if (clip.nextRemainder >= clip.frameRateSpeed) {
+			clip.nextRemainder -= clip.frameRateSpeed;
+			clip.nextStart++;
+		}
+	}
+
+	// Frames since the clip started, without wrapping.
+	static int frameAt(const Clip &clip, int32_t ticks) {
+		const int64_t elapsed = static_cast<int64_t>(ticks) - clip.startTime;
+		return elapsed > 0 ? static_cast<int>(elapsed * clip.frameRateSpeed / 1000) : 0;
+	}
+
+	// Appends the slots in [0, count) whose deadline has come to due.
+	void findDue(int32_t ticks, size_t count) {
+		due.clear();
+		size_t i = 0;
+#ifdef ANIMATION_SCAN_SSE2
+		const __m128i now = _mm_set1_epi32(ticks);
+		for (; i + 4 <= count; i += 4) {
+			const __m128i deadline = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&deadlines[i]));
+			int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(deadline, now))) ^ 0xF;
+			while (mask) {
+				const int lane = __builtin_ctz(mask);
+				due.push_back(static_cast<uint32_t>(i + lane));
+				mask &= mask - 1;
+			}
+		}
+#endif
+		for (; i < count; i++) {
+			if (deadlines[i] <= ticks) {
+				due.push_back(static_cast<uint32_t>(i));
+			}
+		}
+	}
+
+	// Whether frame eventFrame is shown anywhere in frame counts (from, to], wrapping around the clip. Steps can
+	// cross several frames, so the event frame may have been passed without being the frame now shown.
+	static bool passesEventFrame(const Clip &clip, int from, int to) {
+		if (clip.eventFrame < 0 || clip.eventFrame >= clip.numFrames) {
+			return false;
+		}
+		const int next = from + 1;
+		const int firstEvent = next + ((clip.eventFrame - next) % clip.numFrames + clip.numFrames) % clip.numFrames;
+		return firstEvent <= to;
+	}
+
+	// Shows the frame due at ticks and sets the slot's next deadline.
+	void advance(size_t slot, int32_t ticks, std::unique_ptr<EventBus> &eventBus) {
+		Clip &clip = clips[slot];
+		Entity entity = entities[slot];
+
+		// Usually a step only reaches the frame the deadline was for, and the frame after it is a step of the
+		// deadline. Steps that skip frames work the frame out from the time.
+		int frameCount = clip.nextCount;
+		stepNextFrame(clip);
+		if (nextStartTime(clip) <= ticks) {
+			frameCount = frameAt(clip, ticks);
+			setNextFrame(clip, frameCount + 1);
+		}
+		const bool isFinished = !clip.isLoop && frameCount >= clip.numFrames - 1;
+		deadlines[slot] = isFinished ? NEVER : nextStartTime(clip);
+
+		const int shownCount = isFinished ? clip.numFrames - 1 : frameCount;
+		int frame = clip.numFrames - 1;
+		if (!isFinished) {
+			if (shownCount == clip.frameCount + 1 && clip.currentFrame >= 0) {
+				frame = clip.currentFrame + 1 < clip.numFrames ? clip.currentFrame + 1 : 0;
+			} else {
+				frame = frameCount % clip.numFrames;
+			}
+		}
+		if (passesEventFrame(clip, clip.frameCount, shownCount)) {
+			eventBus->QueueEvent<AnimationEvent>(entity, clip.eventFrame, false);
+		}
+		clip.frameCount = shownCount;
+
+		if (frame != clip.currentFrame) {
+			clip.currentFrame = frame;
+			auto &sprite = entity.GetComponent<SpriteComponent>();
+			if (frame < clip.numColumns) {
+				sprite.srcRect.x = clip.originX + frame * clip.width;
+				sprite.srcRect.y = clip.originY;
+			} else {
+				sprite.srcRect.x = clip.originX + frame % clip.numColumns * clip.width;
+				sprite.srcRect.y = clip.originY + frame / clip.numColumns * clip.height;
+			}
+			entity.GetComponent<AnimationComponent>().currentFrame = frame;
+		}
+		if (isFinished) {
+			eventBus->QueueEvent<AnimationEvent>(entity, frame, true);
+		}
+	}
+
+protected:
+	void OnEntityAdded(Entity entity) override {
+		const auto &animation = entity.GetComponent<AnimationComponent>();
+		const auto &sprite = entity.GetComponent<SpriteComponent>();
+
+		const size_t entityId = entity.GetId();
+		if (entityId >= slots.size()) {
+			slots.resize(entityId + 1);
+		}
+		const size_t slot = clips.size();
+		slots[entityId] = slot;
+		entities.push_back(entity);
+		clips.push_back({
+			animation.startTime,
+			animation.frameRateSpeed,
+			animation.numFrames,
+			animation.numColumns > 0 ? animation.numColumns : animation.numFrames,
+			animation.eventFrame,
+			animation.isLoop,
+			-1,
+			0,
+			0,
+			0,
+			0,
+			animation.frameRateSpeed > 0 ? 1000 / animation.frameRateSpeed : 0,
+			animation.frameRateSpeed > 0 ? 1000 % animation.frameRateSpeed : 0,
+			sprite.srcRect.x,
+			sprite.srcRect.y,
+			sprite.width,
+			sprite.height
+		});
+		// New clips are due at once, so the first update shows their first frame and queues their events; a clip
+		// of one frame that doesn't loop finishes there.
+		deadlines.push_back(animation.numFrames > 0 && animation.frameRateSpeed > 0 ? animation.startTime : NEVER);
+	}
+
+	void OnEntityRemoved(Entity entity) override {
+		const size_t slot = slots[entity.GetId()];
+		const size_t last = clips.size() - 1;
+		deadlines[slot] = deadlines[last];
+		clips[slot] = clips[last];
+		entities[slot] = entities[last];
+		slots[entities[slot].GetId()] = slot;
+		deadlines.pop_back();
+		clips.pop_back();
+		entities.pop_back();
+	}
+
 public:
 	AnimationSystem() {
 		RequireComponent<SpriteComponent>();
 		RequireComponent<AnimationComponent>();
 	}
 
-	void Update() {
-		for (auto entity: GetSystemEntities()) {
-			auto &animation = entity.GetComponent<AnimationComponent>();
-			auto &sprite = entity.GetComponent<SpriteComponent>();
-
-			animation.currentFrame = ((SDL_GetTicks() - animation.startTime) * animation.frameRateSpeed / 1000) % animation.numFrames;
-			sprite.srcRect.x = animation.currentFrame * sprite.width;
+	// ticks is the game time of the current step.
+	void Update(Uint32 ticks, std::unique_ptr<EventBus> &eventBus) {
+		const int32_t now = static_cast<int32_t>(ticks);
+		findDue(now, deadlines.size());
+		for (auto slot: due) {
+			advance(slot, now, eventBus);
 		}
 	}
 };
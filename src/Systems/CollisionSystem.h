@@ -5,50 +5,360 @@
 #include "../Logger/Logger.h"
 #include "../EventBus/EventBus.h"
 #include "../Events/CollisionEvent.h"
+#include "../Events/CollisionEnterEvent.h"
+#include "../Events/CollisionExitEvent.h"
 #include "../Components/BoxColliderComponent.h"
 #include "../Components/TransformComponent.h"
+#include "../Collision/AABB.h"
+#include "../Collision/AABBKernel.h"
+#include "../Collision/Broadphase.h"
+#include "../Collision/ContactCache.h"
+#include "../Collision/SpatialQuery.h"
+#include "../Jobs/ThreadPool.h"
 
 class CollisionSystem : public System {
 private:
-	bool checkAABBCollision(double aX, double aY, double aW, double aH, double bX, double bY, double bW, double bH) {
-		return aX < bX + bW
-			&& aX + aW > bX
-			&& aY < bY + bH
-			&& aY + aH > bY;
+	struct ContactPair {
+		uint32_t a;
+		uint32_t b;
+		float timeOfImpact;
+		bool isNew;
+
+		bool operator <(const ContactPair &other) const {
+			return a != other.a ? a < other.a : b < other.b;
+		}
+	};
+
+	// Each narrowphase thread writes into its own buffers; they are merged and sorted on the calling thread.
+	struct NarrowphaseBuffer {
+		AABBArray cellBoxes;
+		std::vector<uint8_t> hitMasks;
+		std::vector<ContactPair> contacts;
+	};
+
+	static const size_t MIN_COLLIDERS_FOR_THREADS = 256;
+
+	std::vector<Entity> entities;
+	AABBArray boxes;
+	Broadphase broadphase;
+	SpatialQuery spatialQuery;
+	std::vector<NarrowphaseBuffer> narrowphaseBuffers;
+	std::vector<ContactPair> contacts;
+
+	std::vector<float> displacementX;
+	std::vector<float> displacementY;
+	std::vector<uint32_t> fastMovers;
+	// Movers are binned by their swept bounds, so two movers that cross mid-step find each other even when
+	// neither end box is inside the other's swept bounds. sweptFrames marks the movers already swept this step.
+	AABBArray sweptBoxes;
+	Broadphase moverBroadphase;
+	std::vector<uint32_t> sweptFrames;
+	std::vector<uint32_t> sweepStamps;
+	std::vector<uint32_t> sweepCandidates;
+	std::vector<float> candidateDisplacementX;
+	std::vector<float> candidateDisplacementY;
+	std::vector<float> timesOfImpact;
+	AABBArray candidateBoxes;
+	uint32_t sweepStamp = 0;
+
+	ContactCache contactCache;
+	std::vector<uint32_t> aliveFrames;
+	std::vector<std::pair<int, int>> exits;
+	uint32_t frame = 0;
+	bool emitStayEvents = false;
+
+	void findCellContacts(size_t cell, NarrowphaseBuffer &buffer) {
+		size_t count;
+		const uint32_t *items = broadphase.GetCellItems(cell, count);
+		if (count < 2) {
+			return;
+		}
+
+		AABBArray &cellBoxes = buffer.cellBoxes;
+		std::vector<uint8_t> &hitMasks = buffer.hitMasks;
+
+		cellBoxes.Clear();
+		for (size_t i = 0; i < count; i++) {
+			cellBoxes.Add(boxes.Get(items[i]));
+		}
+
+		for (size_t i = 0; i + 1 < count; i++) {
+			const size_t first = i + 1;
+			const size_t numOthers = count - first;
+			const AABB box = cellBoxes.Get(i);
+
+			hitMasks.resize((numOthers + 7) / 8);
+			OverlapBatch(
+				box,
+				cellBoxes.minX.data() + first, cellBoxes.minY.data() + first,
+				cellBoxes.maxX.data() + first, cellBoxes.maxY.data() + first,
+				numOthers,
+				hitMasks.data()
+			);
+
+			for (size_t byte = 0; byte < hitMasks.size(); byte++) {
+				unsigned int mask = hitMasks[byte];
+				while (mask) {
+					const size_t j = first + byte * 8 + __builtin_ctz(mask);
+					mask &= mask - 1;
+
+					if (!broadphase.OwnsPair(cell, box, cellBoxes.Get(j))) {
+						continue;
+					}
+
+					uint32_t a = items[i];
+					uint32_t b = items[j];
+					buffer.contacts.push_back(a < b ? ContactPair{a, b, 1.0f, false} : ContactPair{b, a, 1.0f, false});
+				}
+			}
+		}
+	}
+
+	bool isAlive(int entityId) const {
+		return entityId < static_cast<int>(aliveFrames.size()) && aliveFrames[entityId] == frame;
+	}
+
+	AABB startOfStep(uint32_t idx) const {
+		AABB box = boxes.Get(idx);
+		box.minX -= displacementX[idx];
+		box.maxX -= displacementX[idx];
+		box.minY -= displacementY[idx];
+		box.maxY -= displacementY[idx];
+		return box;
+	}
+
+	AABB sweptBounds(uint32_t idx) const {
+		const AABB end = boxes.Get(idx);
+		const AABB start = startOfStep(idx);
+		return {
+			std::min(start.minX, end.minX),
+			std::min(start.minY, end.minY),
+			std::max(start.maxX, end.maxX),
+			std::max(start.maxY, end.maxY)
+		};
+	}
+
+	bool isMoving(uint32_t idx) const {
+		return displacementX[idx] != 0 || displacementY[idx] != 0;
+	}
+
+	void addSweepCandidate(uint32_t other) {
+		sweepCandidates.push_back(other);
+		candidateBoxes.Add(startOfStep(other));
+		candidateDisplacementX.push_back(displacementX[other]);
+		candidateDisplacementY.push_back(displacementY[other]);
+	}
+
+	// Catches fast movers that passed through a collider between two steps. Boxes still overlapping at the
+	// end of the step were already reported by the discrete pass, so only tunnelling hits are added here.
+	// Still colliders are found in the broadphase cells the mover's swept bounds cover; other movers are found
+	// through their own swept bounds. Overlapping swept bounds find each other both ways, so a pair of movers is
+	// only swept by whichever of them is swept first.
+	void sweepFastMover(uint32_t mover) {
+		const AABB end = boxes.Get(mover);
+		const AABB start = startOfStep(mover);
+		const AABB swept = sweptBounds(mover);
+
+		sweepStamp++;
+		sweepStamps[mover] = sweepStamp;
+		sweptFrames[mover] = frame;
+		sweepCandidates.clear();
+		candidateBoxes.Clear();
+		candidateDisplacementX.clear();
+		candidateDisplacementY.clear();
+
+		int minCol, minRow, maxCol, maxRow;
+		broadphase.GetCellRange(swept, minCol, minRow, maxCol, maxRow);
+		for (int row = minRow; row <= maxRow; row++) {
+			for (int col = minCol; col <= maxCol; col++) {
+				size_t count;
+				const uint32_t *items = broadphase.GetCellItems(broadphase.GetCellIndex(col, row), count);
+				for (size_t i = 0; i < count; i++) {
+					const uint32_t other = items[i];
+					if (isMoving(other) || sweepStamps[other] == sweepStamp) {
+						continue;
+					}
+					sweepStamps[other] = sweepStamp;
+
+					if (AABBOverlaps(end, boxes.Get(other))) {
+						continue;
+					}
+					addSweepCandidate(other);
+				}
+			}
+		}
+
+		moverBroadphase.GetCellRange(swept, minCol, minRow, maxCol, maxRow);
+		for (int row = minRow; row <= maxRow; row++) {
+			for (int col = minCol; col <= maxCol; col++) {
+				size_t count;
+				const uint32_t *items = moverBroadphase.GetCellItems(moverBroadphase.GetCellIndex(col, row), count);
+				for (size_t i = 0; i < count; i++) {
+					const uint32_t other = fastMovers[items[i]];
+					if (sweptFrames[other] == frame || sweepStamps[other] == sweepStamp) {
+						continue;
+					}
+					sweepStamps[other] = sweepStamp;
+
+					if (!AABBOverlaps(swept, sweptBoxes.Get(items[i])) || AABBOverlaps(end, boxes.Get(other))) {
+						continue;
+					}
+					addSweepCandidate(other);
+				}
+			}
+		}
+
+		const size_t numCandidates = sweepCandidates.size();
+		if (numCandidates == 0) {
+			return;
+		}
+
+		timesOfImpact.resize(numCandidates);
+		SweepBatch(
+			start, displacementX[mover], displacementY[mover],
+			candidateBoxes.minX.data(), candidateBoxes.minY.data(),
+			candidateBoxes.maxX.data(), candidateBoxes.maxY.data(),
+			candidateDisplacementX.data(), candidateDisplacementY.data(),
+			numCandidates,
+			timesOfImpact.data()
+		);
+
+		for (size_t i = 0; i < numCandidates; i++) {
+			if (timesOfImpact[i] > 1.0f) {
+				continue;
+			}
+			uint32_t a = std::min(mover, sweepCandidates[i]);
+			uint32_t b = std::max(mover, sweepCandidates[i]);
+			contacts.push_back({a, b, timesOfImpact[i], false});
+		}
 	}
 
 public:
-	CollisionSystem() {
+	CollisionSystem(): spatialQuery(broadphase, boxes, entities) {
 		RequireComponent<BoxColliderComponent>();
 		RequireComponent<TransformComponent>();
 	}
 
-	void Update(std::unique_ptr<EventBus>& eventBus) {
-		std::vector<Entity> entities = GetSystemEntities();
-		for (auto i = entities.begin(); i != entities.end(); i++) {
-			Entity entityA = *i;
-			TransformComponent transformA = entityA.GetComponent<TransformComponent>();
-			BoxColliderComponent &colliderA = entityA.GetComponent<BoxColliderComponent>();
+	// CollisionEvent is sent for every touching pair on every step; it's off by default as most handlers
+	// only care about CollisionEnterEvent/CollisionExitEvent.
+	void SetEmitStayEvents(bool emit) {
+		emitStayEvents = emit;
+	}
 
-			for (auto j = i; j != entities.end(); j++) {
-				Entity entityB = *j;
+	size_t NumContacts() const {
+		return contactCache.Size();
+	}
 
-				if (entityA == entityB) {
-					continue;
-				}
+	// Queries see the colliders as they were at the end of the last Update.
+	SpatialQuery &GetSpatialQuery() {
+		return spatialQuery;
+	}
+
+	void Update(std::unique_ptr<EventBus>& eventBus, std::unique_ptr<ThreadPool>& threadPool) {
+		entities = GetSystemEntities();
+
+		frame++;
+		for (auto entity: entities) {
+			if (entity.GetId() >= static_cast<int>(aliveFrames.size())) {
+				aliveFrames.resize(entity.GetId() + 1, 0);
+			}
+			aliveFrames[entity.GetId()] = frame;
+		}
 
-				TransformComponent transformB = entityB.GetComponent<TransformComponent>();
-				BoxColliderComponent &colliderB = entityB.GetComponent<BoxColliderComponent>();
-
-				bool isColliding = checkAABBCollision(
-					transformA.position.x, transformA.position.y,
-					colliderA.width, colliderA.height,
-					transformB.position.x, transformB.position.y,
-					colliderB.width, colliderB.height
-				);
-				if (isColliding) {
-					eventBus->EmitEvent<CollisionEvent>(entityA, entityB);
+		boxes.Clear();
+		displacementX.clear();
+		displacementY.clear();
+		fastMovers.clear();
+		for (size_t i = 0; i < entities.size(); i++) {
+			const auto &transform = entities[i].GetComponent<TransformComponent>();
+			auto &collider = entities[i].GetComponent<BoxColliderComponent>();
+			boxes.Add(GetColliderBounds(transform, collider));
+
+			glm::vec2 displacement(0);
+			if (collider.isFast) {
+				if (collider.hasPreviousPosition) {
+					displacement = transform.position - collider.previousPosition;
 				}
+				collider.previousPosition = transform.position;
+				collider.hasPreviousPosition = true;
+			}
+			displacementX.push_back(displacement.x);
+			displacementY.push_back(displacement.y);
+			if (displacement.x != 0 || displacement.y != 0) {
+				fastMovers.push_back(static_cast<uint32_t>(i));
+			}
+		}
+
+		broadphase.Build(boxes);
+
+		const size_t numThreads = boxes.Size() >= MIN_COLLIDERS_FOR_THREADS ? threadPool->NumThreads() : 1;
+		narrowphaseBuffers.resize(std::max(narrowphaseBuffers.size(), numThreads));
+		// The pool doesn't call threads whose range is empty, so buffers are cleared here rather than by each thread.
+		for (size_t i = 0; i < numThreads; i++) {
+			narrowphaseBuffers[i].contacts.clear();
+		}
+
+		auto findContacts = [this](size_t firstCell, size_t lastCell, size_t threadIdx) {
+			NarrowphaseBuffer &buffer = narrowphaseBuffers[threadIdx];
+			for (size_t cell = firstCell; cell < lastCell; cell++) {
+				findCellContacts(cell, buffer);
+			}
+		};
+		if (numThreads > 1) {
+			threadPool->ParallelFor(broadphase.NumCells(), findContacts);
+		} else {
+			findContacts(0, broadphase.NumCells(), 0);
+		}
+
+		contacts.clear();
+		for (size_t i = 0; i < numThreads; i++) {
+			contacts.insert(contacts.end(), narrowphaseBuffers[i].contacts.begin(), narrowphaseBuffers[i].contacts.end());
+		}
+
+		if (!fastMovers.empty()) {
+			sweepStamps.resize(entities.size());
+			sweptFrames.resize(entities.size());
+			sweptBoxes.Clear();
+			for (auto mover: fastMovers) {
+				sweptBoxes.Add(sweptBounds(mover));
+			}
+			moverBroadphase.Build(sweptBoxes);
+			for (auto mover: fastMovers) {
+				sweepFastMover(mover);
+			}
+		}
+
+		// Sorting by pair makes the event order independent of the cell visiting order and of the thread count.
+		std::sort(contacts.begin(), contacts.end());
+
+		contactCache.BeginFrame();
+		for (auto &contact: contacts) {
+			contact.isNew = contactCache.Touch(entities[contact.a].GetId(), entities[contact.b].GetId());
+		}
+
+		exits.clear();
+		contactCache.RemoveStale([this](int a, int b) {
+			if (isAlive(a) || isAlive(b)) {
+				exits.emplace_back(a, b);
+			}
+		});
+		std::sort(exits.begin(), exits.end());
+
+		for (auto exit: exits) {
+			Entity a(exit.first);
+			Entity b(exit.second);
+			a.entityManager = b.entityManager = entities.front().entityManager;
+			eventBus->QueueEvent<CollisionExitEvent>(a, b);
+		}
+
+		for (auto contact: contacts) {
+			Entity a = entities[contact.a];
+			Entity b = entities[contact.b];
+			if (contact.isNew) {
+				eventBus->QueueEvent<CollisionEnterEvent>(a, b, contact.timeOfImpact);
+			}
+			if (emitStayEvents) {
+				eventBus->QueueEvent<CollisionEvent>(a, b, contact.timeOfImpact);
 			}
 		}
 	}
@@ -3,7 +3,7 @@
 
 #include "../ECS/ECS.h"
 #include "../EventBus/EventBus.h"
-#include "../Events/CollisionEvent.h"
+#include "../Events/CollisionEnterEvent.h"
 #include "../Components/BoxColliderComponent.h"
 #include "../Components/ProjectileComponent.h"
 #include "../Components/HealthComponent.h"
@@ -43,24 +43,27 @@ public:
 	}
 
 	void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-		eventBus->SubscribeToEvent<CollisionEvent>(this, &DamageSystem::OnCollision);
+		const EventFilter projectileHits(EntityFilter::Group("projectiles"), EntityFilter::Tag("player") | EntityFilter::Group("enemies"));
+		eventBus->SubscribeToEventBatch<CollisionEnterEvent, &DamageSystem::OnCollisions>(this, projectileHits);
 	}
 
-	void OnCollision(CollisionEvent& event) {
-		Entity a = event.a;
-		Entity b = event.b;
+	void OnCollisions(EventSpan<CollisionEnterEvent> events) {
+		for (auto &event: events) {
+			Entity a = event.a;
+			Entity b = event.b;
 
-		if (a.InGroup("projectiles") && b.HasTag("player")) {
-			onProjectileHitsPlayer(a, b);
-		}
-		if (b.InGroup("projectiles") && a.HasTag("player")) {
-			onProjectileHitsPlayer(b, a);
-		}
-		if (a.InGroup("projectiles") && b.InGroup("enemies")) {
-			onProjectileHitsEnemy(a, b);
-		}
-		if (b.InGroup("projectiles") && a.InGroup("enemies")) {
-			onProjectileHitsEnemy(b, a);
+			if (a.InGroup("projectiles") && b.HasTag("player")) {
+				onProjectileHitsPlayer(a, b);
+			}
+			if (b.InGroup("projectiles") && a.HasTag("player")) {
+				onProjectileHitsPlayer(b, a);
+			}
+			if (a.InGroup("projectiles") && b.InGroup("enemies")) {
+				onProjectileHitsEnemy(a, b);
+			}
+			if (b.InGroup("projectiles") && a.InGroup("enemies")) {
+				onProjectileHitsEnemy(b, a);
+			}
 		}
 	}
 };
@@ -0,0 +1,24 @@
+#ifndef INTERPOLATION_SYSTEM_H
+#define INTERPOLATION_SYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+
+// Runs at the start of every simulation step and remembers where each entity was, so frames rendered between two
+// steps can draw it part way between its previous and current transform.
+class InterpolationSystem : public System {
+public:
+	InterpolationSystem() {
+		RequireComponent<TransformComponent>();
+	}
+
+	void Update() {
+		for (auto entity: GetSystemEntities()) {
+			auto &transform = entity.GetComponent<TransformComponent>();
+			transform.previousPosition = transform.position;
+			transform.previousRotation = transform.rotation;
+		}
+	}
+};
+
+#endif // INTERPOLATION_SYSTEM_H
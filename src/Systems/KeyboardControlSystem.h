@@ -17,7 +17,7 @@ public:
 	}
 
 	void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-		eventBus->SubscribeToEvent<KeyPressedEvent>(this, &KeyboardControlSystem::OnKeyPressed);
+		eventBus->SubscribeToEvent<KeyPressedEvent, &KeyboardControlSystem::OnKeyPressed>(this);
 	}
 
 	void OnKeyPressed(KeyPressedEvent& event) {
@@ -6,7 +6,7 @@
 #include "../Components/TransformComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/SpriteComponent.h"
-#include "../Events/CollisionEvent.h"
+#include "../Events/CollisionEnterEvent.h"
 
 class MovementSystem : public System {
 public:
@@ -16,10 +16,11 @@ public:
 	}
 
 	void SubscribeToEvents(const std::unique_ptr<EventBus>& eventBus) {
-		eventBus->SubscribeToEvent<CollisionEvent>(this, &MovementSystem::OnCollision);
+		const EventFilter enemyHitsWorld(EntityFilter::Group(Game::Groups[Game::ENEMIES]), EntityFilter::Group(Game::Groups[Game::WORLD]));
+		eventBus->SubscribeToEvent<CollisionEnterEvent, &MovementSystem::OnCollision>(this, enemyHitsWorld);
 	}
 
-	void OnCollision(CollisionEvent& event) {
+	void OnCollision(CollisionEnterEvent& event) {
 		Entity a = event.a;
 		Entity b = event.b;
 
@@ -0,0 +1,152 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <SDL2/SDL.h>
+#include "../ECS/ECS.h"
+#include "../Logger/Logger.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/ParticleEmitterComponent.h"
+#include "../Particles/ParticleBuffer.h"
+#include "../Renderer/RenderSnapshot.h"
+
+// Particles aren't entities: emitters spawn them into one ParticleBuffer, which is integrated in bulk and drawn as
+// untextured quads in a single SDL_RenderGeometry call. Once the buffer is full new particles are dropped.
+class ParticleSystem : public System {
+private:
+	static constexpr size_t MAX_PARTICLES = 262144;
+
+	ParticleBuffer particles;
+	// Particles don't affect gameplay, so they get their own generator and leave Lua's seeded one alone.
+	std::minstd_rand random;
+	size_t numDropped;
+	// A full buffer tends to stay full for a while, so it's only reported the first time.
+	bool hasWarnedFull;
+
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
+
+	float randomRange(float min, float max) {
+		return min + (max - min) * std::uniform_real_distribution<float>(0.0f, 1.0f)(random);
+	}
+
+	void emit(const ParticleEmitterComponent &emitter, const glm::vec2 &position, int numParticles) {
+		for (int i = 0; i < numParticles; i++) {
+			const float angle = glm::radians(emitter.direction + randomRange(-emitter.spread, emitter.spread));
+			const float speed = randomRange(emitter.minSpeed, emitter.maxSpeed);
+			const ParticleSpawn spawn = {
+				position,
+				glm::vec2(std::cos(angle), std::sin(angle)) * speed,
+				emitter.gravity,
+				randomRange(emitter.minLifetime, emitter.maxLifetime),
+				emitter.startSize,
+				emitter.endSize,
+				emitter.startColor,
+				emitter.endColor
+			};
+			if (!particles.Add(spawn)) {
+				numDropped++;
+			}
+		}
+	}
+
+	static Uint8 toColorChannel(float value) {
+		return static_cast<Uint8>(std::clamp(value, 0.0f, 255.0f));
+	}
+
+public:
+	ParticleSystem(): particles(MAX_PARTICLES) {
+		numDropped = 0;
+		hasWarnedFull = false;
+		RequireComponent<TransformComponent>();
+		RequireComponent<ParticleEmitterComponent>();
+	}
+
+	size_t NumParticles() const {
+		return particles.count;
+	}
+
+	void Update(double deltaTime) {
+		particles.Update(static_cast<float>(deltaTime));
+
+		numDropped = 0;
+		for (auto entity: GetSystemEntities()) {
+			auto &emitter = entity.GetComponent<ParticleEmitterComponent>();
+			const auto &transform = entity.GetComponent<TransformComponent>();
+
+			emitter.emissionDebt += emitter.rate * static_cast<float>(deltaTime);
+			const int numParticles = static_cast<int>(emitter.emissionDebt) + emitter.pendingBurst;
+			emitter.emissionDebt -= static_cast<int>(emitter.emissionDebt);
+			emitter.pendingBurst = 0;
+
+			emit(emitter, transform.position + emitter.offset, numParticles);
+		}
+		if (numDropped > 0 && !hasWarnedFull) {
+			Logger::Warn("particle buffer full, dropped " + std::to_string(numDropped) + " particles; further drops aren't logged");
+			hasWarnedFull = true;
+		}
+	}
+
+	// Only the particles inside view are copied.
+	void Extract(RenderSnapshot &snapshot, const SDL_Rect &view) {
+		for (size_t i = 0; i < particles.count; i++) {
+			const float halfSize = particles.size[i] / 2.0f;
+			if (particles.posX[i] + halfSize < view.x || particles.posX[i] - halfSize > view.x + view.w
+				|| particles.posY[i] + halfSize < view.y || particles.posY[i] - halfSize > view.y + view.h) {
+				continue;
+			}
+			snapshot.particles.push_back({
+				particles.posX[i],
+				particles.posY[i],
+				particles.size[i],
+				{toColorChannel(particles.r[i]), toColorChannel(particles.g[i]), toColorChannel(particles.b[i]), toColorChannel(particles.a[i])}
+			});
+		}
+	}
+
+	void Draw(SDL_Renderer *renderer, const RenderSnapshot &snapshot) {
+		if (snapshot.particles.empty()) {
+			return;
+		}
+		const SDL_Rect camera = snapshot.InterpolatedCamera();
+
+		vertices.resize(snapshot.particles.size() * 4);
+		indices.resize(snapshot.particles.size() * 6);
+		for (size_t i = 0; i < snapshot.particles.size(); i++) {
+			const ParticleSnapshot &particle = snapshot.particles[i];
+			const float halfSize = particle.size / 2.0f;
+			const float minX = particle.x - halfSize - camera.x;
+			const float minY = particle.y - halfSize - camera.y;
+			const float corners[4][2] = {
+				{minX, minY},
+				{minX + particle.size, minY},
+				{minX + particle.size, minY + particle.size},
+				{minX, minY + particle.size}
+			};
+			for (int corner = 0; corner < 4; corner++) {
+				SDL_Vertex &vertex = vertices[i * 4 + corner];
+				vertex.position.x = corners[corner][0];
+				vertex.position.y = corners[corner][1];
+				vertex.color = particle.color;
+				vertex.tex_coord.x = 0.0f;
+				vertex.tex_coord.y = 0.0f;
+			}
+
+			const int firstVertex = static_cast<int>(i * 4);
+			const int quadIndices[6] = {0, 1, 2, 0, 2, 3};
+			for (int j = 0; j < 6; j++) {
+				indices[i * 6 + j] = firstVertex + quadIndices[j];
+			}
+		}
+
+		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+		if (SDL_RenderGeometry(renderer, NULL, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size())) != 0) {
+			Logger::Err(std::string("error drawing particles: ") + SDL_GetError());
+		}
+	}
+};
+
+#endif // PARTICLE_SYSTEM_H
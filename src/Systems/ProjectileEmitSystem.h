@@ -3,6 +3,7 @@
 
 #include <SDL2/SDL.h>
 #include "../Game/Game.h"
+#include "../Game/Clock.h"
 #include "../ECS/ECS.h"
 #include "../EventBus/EventBus.h"
 #include "../Events/KeyPressedEvent.h"
@@ -27,7 +28,7 @@ private:
 		projectile.AddComponent<TransformComponent>(projectilePos, glm::vec2(1.0, 1.0), 0.0);
 		projectile.AddComponent<RigidBodyComponent>(projectileVel);
 		projectile.AddComponent<SpriteComponent>("bullet-texture", 4, 4, 4);
-		projectile.AddComponent<BoxColliderComponent>(4, 4);
+		projectile.AddComponent<BoxColliderComponent>(4, 4, glm::vec2(0), true);
 		projectile.AddComponent<ProjectileComponent>(projectileEmitter.isFriendly, projectileEmitter.hitPercentDamage, projectileEmitter.projectileDuration);
 	}
 
@@ -38,7 +39,7 @@ public:
 	}
 
 	void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-		eventBus->SubscribeToEvent<KeyPressedEvent>(this, &ProjectileEmitSystem::OnKeyPressed);
+		eventBus->SubscribeToEvent<KeyPressedEvent, &ProjectileEmitSystem::OnKeyPressed>(this);
 	}
 
 	void OnKeyPressed(KeyPressedEvent& event) {
@@ -87,7 +88,7 @@ public:
 			}
 
 			// TODO: DRY
-			if (SDL_GetTicks() - projectileEmitter.lastEmissionTime > projectileEmitter.repeatFreq) {
+			if (Clock::GetTicks() - projectileEmitter.lastEmissionTime > projectileEmitter.repeatFreq) {
 				glm::vec2 projectilePosition = transform.position;
 				if (entity.HasComponent<SpriteComponent>()) {
 					auto sprite = entity.GetComponent<SpriteComponent>();
@@ -110,7 +111,7 @@ public:
 
 				emitProjectile(entity, projectilePosition, projectileEmitter.projectileVelocity, projectileEmitter);
 
-				projectileEmitter.lastEmissionTime = SDL_GetTicks();
+				projectileEmitter.lastEmissionTime = Clock::GetTicks();
 			}
 		}
 	}
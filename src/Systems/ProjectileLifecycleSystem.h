@@ -2,6 +2,7 @@
 #define PROJECTILE_LIFECYCLE_SYSTEM_H
 
 #include "../ECS/ECS.h"
+#include "../Game/Clock.h"
 #include "../Components/ProjectileComponent.h"
 
 class ProjectileLifecycleSystem: public System {
@@ -14,7 +15,7 @@ public:
 		for (auto entity: GetSystemEntities()) {
 			auto projectile = entity.GetComponent<ProjectileComponent>();
 
-			if (SDL_GetTicks() - projectile.startTime > projectile.duration) {
+			if (Clock::GetTicks() - projectile.startTime > projectile.duration) {
 				entity.Kill();
 			}
 		}
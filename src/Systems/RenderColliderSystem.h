@@ -4,9 +4,14 @@
 #include <SDL2/SDL.h>
 #include "../ECS/ECS.h"
 #include "../EventBus/EventBus.h"
-#include "../Events/CollisionEvent.h"
+#include "../Events/CollisionEnterEvent.h"
+#include "../Events/CollisionExitEvent.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/BoxColliderComponent.h"
+#include "../Collision/AABB.h"
+#include "../Renderer/RenderSnapshot.h"
+#include "../Renderer/DebugDraw.h"
+#include "VisibilitySystem.h"
 
 class RenderColliderSystem : public System {
 public:
@@ -16,30 +21,62 @@ public:
 	}
 
 	void SubscribeToEvents(std::unique_ptr<EventBus> &eventBus) {
-		eventBus->SubscribeToEvent<CollisionEvent>(this, &RenderColliderSystem::onCollision);
+		eventBus->SubscribeToEvent<CollisionEnterEvent, &RenderColliderSystem::onCollisionEnter>(this);
+		eventBus->SubscribeToEvent<CollisionExitEvent, &RenderColliderSystem::onCollisionExit>(this);
 	}
 
-	void onCollision(CollisionEvent &event) {
-		event.a.GetComponent<BoxColliderComponent>().colour = {255, 0, 0, 255};
-		event.b.GetComponent<BoxColliderComponent>().colour = {255, 0, 0, 255};
+	void onCollisionEnter(CollisionEnterEvent &event) {
+		addContact(event.a, 1);
+		addContact(event.b, 1);
 	}
 
-	void Update(SDL_Renderer *renderer, SDL_Rect camera) {
+	void onCollisionExit(CollisionExitEvent &event) {
+		addContact(event.a, -1);
+		addContact(event.b, -1);
+	}
+
+	void addContact(Entity entity, int delta) {
+		if (!entity.HasComponent<BoxColliderComponent>()) {
+			return;
+		}
+
+		auto &collider = entity.GetComponent<BoxColliderComponent>();
+		collider.numContacts = std::max(collider.numContacts + delta, 0);
+		collider.colour = collider.numContacts > 0 ? SDL_Color{255, 0, 0, 255} : SDL_Color{255, 255, 0, 255};
+	}
+
+	void Extract(RenderSnapshot &snapshot, const VisibilitySystem &visibility) {
 		for (auto entity: GetSystemEntities()) {
-			const auto transform = entity.GetComponent<TransformComponent>();
-			auto &collider = entity.GetComponent<BoxColliderComponent>();
+			if (!visibility.IsVisible(entity)) {
+				continue;
+			}
 
+			const auto &transform = entity.GetComponent<TransformComponent>();
+			const auto &collider = entity.GetComponent<BoxColliderComponent>();
+
+			const AABB bounds = GetColliderBounds(transform, collider);
+			const glm::vec2 position(bounds.minX, bounds.minY);
+			snapshot.colliders.push_back({
+				position + transform.previousPosition - transform.position,
+				position,
+				glm::vec2(bounds.maxX - bounds.minX, bounds.maxY - bounds.minY),
+				collider.colour
+			});
+		}
+	}
+
+	void Draw(const RenderSnapshot &snapshot, DebugDraw &debugDraw) {
+		const SDL_Rect camera = snapshot.InterpolatedCamera();
+
+		for (const auto &collider: snapshot.colliders) {
+			const glm::vec2 position = snapshot.Interpolate(collider.previousPosition, collider.position);
 			SDL_Rect colliderRect = {
-				static_cast<int>(transform.position.x + collider.offset.x - camera.x),
-				static_cast<int>(transform.position.y + collider.offset.y - camera.y),
-				static_cast<int>(collider.width * transform.scale.x),
-				static_cast<int>(collider.height * transform.scale.y),
+				static_cast<int>(position.x - camera.x),
+				static_cast<int>(position.y - camera.y),
+				static_cast<int>(collider.size.x),
+				static_cast<int>(collider.size.y),
 			};
-			SDL_SetRenderDrawColor(renderer, collider.colour.r, collider.colour.g, collider.colour.b, collider.colour.a);
-			SDL_RenderDrawRect(renderer, &colliderRect);
-
-			// TODO: fix this :(
-			// collider.colour = {255, 255, 0, 255};
+			debugDraw.DrawRect(colliderRect, collider.colour);
 		}
 	}
 };
@@ -29,6 +29,12 @@ renderInfoOverlay(const std::unique_ptr<EntityManager> &entityManager, SDL_Rect
 		ImGui::Text("Total Entites: %zu", entityManager->NumEntites());
         ImGui::Separator();
 
+		const auto &batchStats = entityManager->GetSystem<RenderSystem>().GetBatchStats();
+		ImGui::Text("Frame time: %.2f ms", 1000.0f / io.Framerate);
+		ImGui::Text("Sprites: %zu in %zu draw calls", batchStats.numSprites, batchStats.numDrawCalls);
+		ImGui::Text("Particles: %zu", entityManager->GetSystem<ParticleSystem>().NumParticles());
+        ImGui::Separator();
+
 		ImGui::SeparatorText("Entities by Group");
         ImGui::Separator();
 
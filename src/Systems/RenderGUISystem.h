@@ -11,6 +11,8 @@
 #include "../Components/BoxColliderComponent.h"
 #include "../Components/ProjectileEmitterComponent.h"
 #include "../Components/HealthComponent.h"
+#include "RenderSystem.h"
+#include "ParticleSystem.h"
 
 void renderInfoOverlay(const std::unique_ptr<EntityManager> &entityManager, SDL_Rect &camera);
 void renderAddEnemies(const std::unique_ptr<EntityManager> &entityManager, SDL_Rect &camera);
@@ -1,15 +1,39 @@
 #ifndef RENDER_HEALTH_BAR_SYSTEM_H
 #define RENDER_HEALTH_BAR_SYSTEM_H
 
+#include <vector>
 #include <SDL2/SDL.h>
 #include "../ECS/ECS.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../Components/HealthComponent.h"
 #include "../AssetStore/AssetStore.h"
+#include "../Renderer/TextBatcher.h"
+#include "../Renderer/RenderSnapshot.h"
+#include "VisibilitySystem.h"
 
 class RenderHealthBarSystem : public System {
-public:
+    private:
+        // Bars are grouped by colour so each colour is one SDL_RenderFillRects call, and all the percentages go
+        // through the text batcher.
+        struct BarBatch {
+            SDL_Color color;
+            std::vector<SDL_Rect> rects;
+        };
+
+        std::vector<BarBatch> barBatches;
+        TextBatcher textBatcher;
+
+        std::vector<SDL_Rect> &barRects(SDL_Color color) {
+            for (auto &batch: barBatches) {
+                if (batch.color.r == color.r && batch.color.g == color.g && batch.color.b == color.b) {
+                    return batch.rects;
+                }
+            }
+            barBatches.push_back({color, {}});
+            return barBatches.back().rects;
+        }
+
     public:
         RenderHealthBarSystem() {
             RequireComponent<TransformComponent>();
@@ -17,61 +41,81 @@ public:
             RequireComponent<HealthComponent>();
         }
 
-        void Update(SDL_Renderer *renderer, const SDL_Rect &camera, const std::unique_ptr<AssetStore> &assetStore) {
+        void Extract(RenderSnapshot &snapshot, const VisibilitySystem &visibility) {
             for (auto entity: GetSystemEntities()) {
-                const auto transform = entity.GetComponent<TransformComponent>();
-                const auto sprite = entity.GetComponent<SpriteComponent>();
-                const auto health = entity.GetComponent<HealthComponent>();
+                if (!visibility.IsVisible(entity)) {
+                    continue;
+                }
+
+                const auto &transform = entity.GetComponent<TransformComponent>();
+                const auto &sprite = entity.GetComponent<SpriteComponent>();
+                const auto &health = entity.GetComponent<HealthComponent>();
 
-                SDL_Color healthBarColor = {255, 255, 255};
+                const glm::vec2 offset(sprite.width * transform.scale.x, 0);
+                snapshot.healthBars.push_back({
+                    transform.previousPosition + offset,
+                    transform.position + offset,
+                    health.healthPercentage
+                });
+            }
+        }
 
-                if (health.healthPercentage >= 0 && health.healthPercentage < 40) {
-                    healthBarColor = {255, 0, 0};
+        void Draw(SDL_Renderer *renderer, const RenderSnapshot &snapshot, const std::unique_ptr<AssetStore> &assetStore) {
+            GlyphAtlas *font = assetStore->GetGlyphAtlas("pico8-font-5");
+            const SDL_Rect camera = snapshot.InterpolatedCamera();
+
+            for (auto &batch: barBatches) {
+                batch.rects.clear();
+            }
+            textBatcher.Begin(renderer);
+
+            for (const auto &healthBar: snapshot.healthBars) {
+                SDL_Color healthBarColor = {255, 255, 255, 255};
+
+                if (healthBar.healthPercentage >= 0 && healthBar.healthPercentage < 40) {
+                    healthBarColor = {255, 0, 0, 255};
                 }
-                if (health.healthPercentage >= 40 && health.healthPercentage < 80) {
-                    healthBarColor = {255, 255, 0};
+                if (healthBar.healthPercentage >= 40 && healthBar.healthPercentage < 80) {
+                    healthBarColor = {255, 255, 0, 255};
                 }
-                if (health.healthPercentage >= 80 && health.healthPercentage <= 100) {
-                    healthBarColor = {0, 255, 0};
+                if (healthBar.healthPercentage >= 80 && healthBar.healthPercentage <= 100) {
+                    healthBarColor = {0, 255, 0, 255};
                 }
 
                 int healthBarWidth = 15;
                 int healthBarHeight = 3;
-                double healthBarPosX = (transform.position.x + (sprite.width * transform.scale.x)) - camera.x;
-                double healthBarPosY = (transform.position.y) - camera.y;
+                const glm::vec2 position = snapshot.Interpolate(healthBar.previousPosition, healthBar.position);
+                double healthBarPosX = position.x - camera.x;
+                double healthBarPosY = position.y - camera.y;
 
                 SDL_Rect healthBarRectangle = {
                     static_cast<int>(healthBarPosX),
                     static_cast<int>(healthBarPosY),
-                    static_cast<int>(healthBarWidth * (health.healthPercentage / 100.0)),
+                    static_cast<int>(healthBarWidth * (healthBar.healthPercentage / 100.0)),
                     static_cast<int>(healthBarHeight)
                 };
-                SDL_SetRenderDrawColor(renderer, healthBarColor.r, healthBarColor.g, healthBarColor.b, 255);
-                SDL_RenderFillRect(renderer, &healthBarRectangle);
-
-                std::string healthText = std::to_string(health.healthPercentage) + "%";
-                SDL_Surface *surface = TTF_RenderText_Blended(
-					assetStore->GetFont("pico8-font-5"),
-					healthText.c_str(),
-					healthBarColor
-				);
-                SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-                SDL_FreeSurface(surface);
-
-                int labelWidth = 0;
-                int labelHeight = 0;
-                SDL_QueryTexture(texture, NULL, NULL, &labelWidth, &labelHeight);
-                SDL_Rect healthBarTextRectangle = {
-                    static_cast<int>(healthBarPosX),
-                    static_cast<int>(healthBarPosY) + 5,
-                    labelWidth,
-                    labelHeight
-                };
+                barRects(healthBarColor).push_back(healthBarRectangle);
 
-                SDL_RenderCopy(renderer, texture, NULL, &healthBarTextRectangle);
+                if (font) {
+                    std::string healthText = std::to_string(healthBar.healthPercentage) + "%";
+                    textBatcher.Draw(
+                        *font,
+                        healthText,
+                        static_cast<int>(healthBarPosX),
+                        static_cast<int>(healthBarPosY) + 5,
+                        healthBarColor
+                    );
+                }
+            }
 
-                SDL_DestroyTexture(texture);
+            for (const auto &batch: barBatches) {
+                if (batch.rects.empty()) {
+                    continue;
+                }
+                SDL_SetRenderDrawColor(renderer, batch.color.r, batch.color.g, batch.color.b, 255);
+                SDL_RenderFillRects(renderer, batch.rects.data(), static_cast<int>(batch.rects.size()));
             }
+            textBatcher.End();
         }
 };
 
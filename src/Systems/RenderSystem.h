@@ -1,69 +1,297 @@
 #ifndef RENDER_SYSTEM_H
 #define RENDER_SYSTEM_H
 
+#include <map>
+#include <vector>
+#include <algorithm>
 #include <SDL2/SDL.h>
 #include "../ECS/ECS.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../AssetStore/AssetStore.h"
+#include "../Renderer/SpriteBatcher.h"
+#include "../Renderer/RenderSnapshot.h"
+#include "../Jobs/ThreadPool.h"
+#include "VisibilitySystem.h"
 
 class RenderSystem : public System {
+private:
+	// Sprites are kept in buckets ordered by z index and then texture, the order the batcher draws them in, so
+	// nothing needs sorting per frame. The buckets only change when entities come and go or a sprite changes z.
+	struct BucketKey {
+		int zIndex;
+		SDL_Texture *texture;
+
+		bool operator <(const BucketKey &other) const {
+			return zIndex != other.zIndex ? zIndex < other.zIndex : texture < other.texture;
+		}
+	};
+
+	// The texture size is copied from the region when the bucket is filled, so Extract needs no SDL calls.
+	struct Bucket {
+		std::vector<Entity> entities;
+		float textureWidth;
+		float textureHeight;
+	};
+
+	// A bucket's place in the flattened list of all sprites that Extract splits across threads.
+	struct BucketRange {
+		const Bucket *bucket;
+		BucketKey key;
+		size_t firstIdx;
+	};
+
+	// A sprite found in the wrong bucket. Its quad is built when the thread buffers are merged, as its texture
+	// may not be in any bucket yet. Its old bucket either draws before its new one, or after.
+	struct MovedSprite {
+		Entity entity;
+		BucketKey key;
+		float textureWidth;
+		float textureHeight;
+		SDL_Rect srcRect;
+		SDL_FRect dstRect;
+		float rotation;
+		SDL_RendererFlip flip;
+		bool isAfterBucket;
+
+		bool drawsBefore(const SpriteRun &bucketRun) const {
+			const BucketKey bucketKey = {bucketRun.zIndex, bucketRun.texture};
+			if (key < bucketKey || bucketKey < key) {
+				return key < bucketKey;
+			}
+			return !isAfterBucket;
+		}
+	};
+
+	struct QueuedSprite {
+		const BucketRange *range;
+		SDL_Rect srcRect;
+		SDL_FRect dstRect;
+		float rotation;
+		SDL_RendererFlip flip;
+	};
+
+	// Visible sprites are queued first and their quads built in a second pass, which keeps the component lookups
+	// of the first pass in a tight loop.
+	struct ExtractBuffer {
+		std::vector<QueuedSprite> queued;
+		SpriteVertexBuffer sprites;
+		std::vector<MovedSprite> moved;
+	};
+
+	static const size_t MIN_SPRITES_FOR_THREADS = 1024;
+
+	struct Location {
+		std::vector<Entity> *bucket;
+		size_t idx;
+	};
+
+	SpriteBatcher spriteBatcher;
+	std::map<BucketKey, Bucket> buckets;
+	// Sprites whose texture hasn't been looked up yet, so they can't be put in a bucket.
+	std::vector<Entity> unresolved;
+	std::vector<Location> locations;
+	std::vector<BucketRange> bucketRanges;
+	std::vector<ExtractBuffer> extractBuffers;
+	std::vector<MovedSprite> moved;
+
+	void insert(std::vector<Entity> &bucket, Entity entity) {
+		const size_t entityId = entity.GetId();
+		if (entityId >= locations.size()) {
+			locations.resize(entityId + 1, {nullptr, 0});
+		}
+		locations[entityId] = {&bucket, bucket.size()};
+		bucket.push_back(entity);
+	}
+
+	std::vector<Entity> &bucketFor(const BucketKey &key, float textureWidth, float textureHeight) {
+		Bucket &bucket = buckets[key];
+		bucket.textureWidth = textureWidth;
+		bucket.textureHeight = textureHeight;
+		return bucket.entities;
+	}
+
+	void remove(Entity entity) {
+		Location &location = locations[entity.GetId()];
+		std::vector<Entity> &bucket = *location.bucket;
+		bucket[location.idx] = bucket.back();
+		locations[bucket[location.idx].GetId()].idx = location.idx;
+		bucket.pop_back();
+		location.bucket = nullptr;
+	}
+
+	void resolveTextures(std::unique_ptr<AssetStore>& assetStore) {
+		for (size_t i = 0; i < unresolved.size();) {
+			Entity entity = unresolved[i];
+			auto &sprite = entity.GetComponent<SpriteComponent>();
+			if (!sprite.texture) {
+				sprite.texture = assetStore->GetTextureRegion(sprite.assetId);
+			}
+			if (!sprite.texture) {
+				i++;
+				continue;
+			}
+			remove(entity);
+			const float width = static_cast<float>(std::max(sprite.texture->textureWidth, 1));
+			const float height = static_cast<float>(std::max(sprite.texture->textureHeight, 1));
+			insert(bucketFor({sprite.zIndex, sprite.texture->texture}, width, height), entity);
+		}
+	}
+
+protected:
+	void OnEntityAdded(Entity entity) override {
+		insert(unresolved, entity);
+	}
+
+	void OnEntityRemoved(Entity entity) override {
+		remove(entity);
+	}
+
 public:
 	RenderSystem() {
 		RequireComponent<TransformComponent>();
 		RequireComponent<SpriteComponent>();
 	}
 
-	void Update(SDL_Renderer *renderer, SDL_Rect &camera, std::unique_ptr<AssetStore>& assetStore) {
-		// TODO: do the sorting somewhere else - rather layers?
-		struct RenderableEntity {
-			TransformComponent transformComponent;
-			SpriteComponent spriteComponent;
-		};
-		std::vector<RenderableEntity> renderableEntities;
-		for (auto entity: GetSystemEntities()) {
-			RenderableEntity renderableEntity;
-			renderableEntity.spriteComponent = entity.GetComponent<SpriteComponent>();
-			renderableEntity.transformComponent = entity.GetComponent<TransformComponent>();
-
-			bool isEntityOutView =
-				renderableEntity.transformComponent.position.x + (renderableEntity.transformComponent.scale.x*renderableEntity.spriteComponent.width) < camera.x
-				|| renderableEntity.transformComponent.position.x > camera.x+camera.w
-				|| renderableEntity.transformComponent.position.y + (renderableEntity.transformComponent.scale.y*renderableEntity.spriteComponent.height) < camera.y
-				|| renderableEntity.transformComponent.position.y > camera.y+camera.h;
-			if (isEntityOutView && !renderableEntity.spriteComponent.isFixed)
+	const SpriteBatchStats &GetBatchStats() const {
+		return spriteBatcher.GetStats();
+	}
+
+	// Runs on the simulation side: culls the visible sprites and builds their quads, interpolated at the snapshot's
+	// alpha, in draw order. Buckets are split into ranges across the thread pool; each thread writes its quads to
+	// its own buffer and the buffers are appended in thread order, so the result doesn't depend on the number of
+	// threads.
+	void Extract(RenderSnapshot &snapshot, std::unique_ptr<AssetStore>& assetStore, const VisibilitySystem &visibility, std::unique_ptr<ThreadPool>& threadPool) {
+		resolveTextures(assetStore);
+
+		bucketRanges.clear();
+		size_t numSprites = 0;
+		for (auto &bucket: buckets) {
+			if (bucket.second.entities.empty()) {
 				continue;
+			}
+			bucketRanges.push_back({&bucket.second, bucket.first, numSprites});
+			numSprites += bucket.second.entities.size();
+		}
 
-			renderableEntities.emplace_back(renderableEntity);
+		const size_t numThreads = numSprites >= MIN_SPRITES_FOR_THREADS ? threadPool->NumThreads() : 1;
+		extractBuffers.resize(std::max(extractBuffers.size(), numThreads));
+
+		for (size_t i = 0; i < numThreads; i++) {
+			extractBuffers[i].queued.clear();
+			extractBuffers[i].sprites.Clear();
+			extractBuffers[i].moved.clear();
 		}
 
-		std::sort(renderableEntities.begin(), renderableEntities.end(), [](const RenderableEntity &a, const RenderableEntity &b) {
-				return a.spriteComponent.zIndex < b.spriteComponent.zIndex;
+		// Workers only read components and the cached texture sizes; they make no AssetStore or SDL calls.
+		const SDL_Rect camera = snapshot.InterpolatedCamera();
+		auto extractSprites = [&](size_t first, size_t last, size_t threadIdx) {
+			ExtractBuffer &buffer = extractBuffers[threadIdx];
+			size_t rangeIdx = std::upper_bound(bucketRanges.begin(), bucketRanges.end(), first, [](size_t idx, const BucketRange &range) {
+				return idx < range.firstIdx;
+			}) - bucketRanges.begin() - 1;
+			for (size_t idx = first; idx < last; idx++) {
+				while (idx >= bucketRanges[rangeIdx].firstIdx + bucketRanges[rangeIdx].bucket->entities.size()) {
+					rangeIdx++;
+				}
+				const BucketRange &range = bucketRanges[rangeIdx];
+				Entity entity = range.bucket->entities[idx - range.firstIdx];
+				if (!visibility.IsVisible(entity)) {
+					continue;
+				}
+
+				const auto &transform = entity.GetComponent<TransformComponent>();
+				const auto &sprite = entity.GetComponent<SpriteComponent>();
+
+				SDL_Rect srcRect = sprite.srcRect;
+				srcRect.x += sprite.texture->rect.x;
+				srcRect.y += sprite.texture->rect.y;
+				const glm::vec2 position = snapshot.Interpolate(transform.previousPosition, transform.position);
+				const SDL_FRect dstRect = {
+					position.x - (sprite.isFixed ? 0 : camera.x),
+					position.y - (sprite.isFixed ? 0 : camera.y),
+					sprite.width * transform.scale.x,
+					sprite.height * transform.scale.y
+				};
+				const float rotation = transform.previousRotation + (transform.rotation - transform.previousRotation) * snapshot.alpha;
+
+				// Sprites that changed z or texture are still drawn at the right depth this frame: they're merged
+				// into place afterwards, and the entities are moved to their new bucket. Off-screen sprites are only
+				// moved once they come into view.
+				const BucketKey key = {sprite.zIndex, sprite.texture->texture};
+				if (key < range.key || range.key < key) {
+					buffer.moved.push_back({
+						entity,
+						key,
+						static_cast<float>(std::max(sprite.texture->textureWidth, 1)),
+						static_cast<float>(std::max(sprite.texture->textureHeight, 1)),
+						srcRect,
+						dstRect,
+						rotation,
+						sprite.isFlipped,
+						key < range.key
+					});
+					continue;
+				}
+
+				buffer.queued.push_back({&range, srcRect, dstRect, rotation, sprite.isFlipped});
+			}
+
+			for (const auto &sprite: buffer.queued) {
+				const BucketRange &range = *sprite.range;
+				buffer.sprites.AddQuad(range.key.texture, range.key.zIndex, range.bucket->textureWidth, range.bucket->textureHeight, sprite.srcRect, sprite.dstRect, sprite.rotation, sprite.flip);
+			}
+		};
+		if (numThreads > 1) {
+			threadPool->ParallelFor(numSprites, extractSprites);
+		} else {
+			extractSprites(0, numSprites, 0);
+		}
+
+		moved.clear();
+		for (size_t i = 0; i < numThreads; i++) {
+			moved.insert(moved.end(), extractBuffers[i].moved.begin(), extractBuffers[i].moved.end());
+		}
+		for (const auto &sprite: moved) {
+			remove(sprite.entity);
+			insert(bucketFor(sprite.key, sprite.textureWidth, sprite.textureHeight), sprite.entity);
+		}
+
+		// Moved sprites keep the order they were found in within their new z and texture, and go before or after
+		// the sprites already in that bucket depending on where they came from, as if the frame had been sorted.
+		std::stable_sort(moved.begin(), moved.end(), [](const MovedSprite &a, const MovedSprite &b) {
+			if (a.key < b.key || b.key < a.key) {
+				return a.key < b.key;
+			}
+			return a.isAfterBucket < b.isAfterBucket;
 		});
 
-		for (auto entity: renderableEntities) {
-			const auto transform = entity.transformComponent;
-			const auto sprite = entity.spriteComponent;
-
-			SDL_Rect srcRect = sprite.srcRect;
-			SDL_Rect dstRect = {
-				static_cast<int>(transform.position.x - (sprite.isFixed ? 0 : camera.x)),
-				static_cast<int>(transform.position.y - (sprite.isFixed ? 0 : camera.y)),
-				static_cast<int>(sprite.width * transform.scale.x),
-				static_cast<int>(sprite.height * transform.scale.y)
-			};
-			SDL_RenderCopyEx(
-					renderer,
-					assetStore->GetTexture(sprite.assetId),
-					&srcRect,
-					&dstRect,
-					transform.rotation,
-					NULL,
-					sprite.isFlipped
-			);
+		if (moved.empty() && numThreads == 1 && snapshot.sprites.vertices.empty()) {
+			std::swap(snapshot.sprites, extractBuffers[0].sprites);
+			return;
 		}
+
+		size_t nextMoved = 0;
+		auto appendMoved = [&](const SpriteRun *before) {
+			while (nextMoved < moved.size() && (!before || moved[nextMoved].drawsBefore(*before))) {
+				const MovedSprite &sprite = moved[nextMoved++];
+				snapshot.sprites.AddQuad(sprite.key.texture, sprite.key.zIndex, sprite.textureWidth, sprite.textureHeight, sprite.srcRect, sprite.dstRect, sprite.rotation, sprite.flip);
+			}
+		};
+		for (size_t i = 0; i < numThreads; i++) {
+			const SpriteVertexBuffer &buffer = extractBuffers[i].sprites;
+			for (const auto &run: buffer.runs) {
+				appendMoved(&run);
+				snapshot.sprites.AppendRun(buffer, run);
+			}
+		}
+		appendMoved(nullptr);
+	}
+
+	// Runs on the render side and only reads the snapshot.
+	void Draw(SDL_Renderer *renderer, const RenderSnapshot &snapshot) {
+		spriteBatcher.Draw(renderer, snapshot.sprites);
 	}
 };
 
 #endif // RENDER_SYSTEM_H
-
@@ -1,42 +1,139 @@
 #ifndef RENDER_TEXT_SYSTEM_H
 #define RENDER_TEXT_SYSTEM_H
 
-#include <SDL2/SDL_ttf.h>
+#include <vector>
 #include "../ECS/ECS.h"
 #include "../AssetStore/AssetStore.h"
 #include "../Components/TextLabelComponent.h"
+#include "../Renderer/TextBatcher.h"
+#include "../Renderer/RenderSnapshot.h"
 
 class RenderTextSystem : public System {
+private:
+	// A cached label's texture in the AssetStore's text cache, with the text, font and colour it was rendered
+	// with. It's rendered again when one of those changes, or after the cache evicted it. Kept here by entity id
+	// rather than on the component, as only the render side touches it.
+	struct CachedLabel {
+		size_t textureHandle = 0;
+		int textureWidth = 0;
+		int textureHeight = 0;
+		std::string text;
+		std::string assetId;
+		SDL_Color color = {0, 0, 0, 0};
+
+		bool IsStale(const TextLabelSnapshot &textLabel) const {
+			return textureHandle == 0
+				|| textLabel.text != text
+				|| textLabel.assetId != assetId
+				|| textLabel.color.r != color.r || textLabel.color.g != color.g || textLabel.color.b != color.b || textLabel.color.a != color.a;
+		}
+	};
+
+	TextBatcher textBatcher;
+	std::vector<CachedLabel> cachedLabels;
+
+	// Labels are placed by their own position rather than a transform, so they aren't in the visibility grid;
+	// world space labels are checked against the camera here instead.
+	static bool isOutView(const TextLabelSnapshot &textLabel, int width, int height, const SDL_Rect &camera) {
+		return !textLabel.isFixed && (
+			textLabel.position.x + width < camera.x
+			|| textLabel.position.x > camera.x + camera.w
+			|| textLabel.position.y + height < camera.y
+			|| textLabel.position.y > camera.y + camera.h
+		);
+	}
+
+	void drawCached(SDL_Renderer *renderer, SDL_Rect camera, const std::unique_ptr<AssetStore> &assetStore, const TextLabelSnapshot &textLabel) {
+		if (textLabel.entityId >= cachedLabels.size()) {
+			cachedLabels.resize(textLabel.entityId + 1);
+		}
+		CachedLabel &cached = cachedLabels[textLabel.entityId];
+		if (cached.textureHandle != 0 && isOutView(textLabel, cached.textureWidth, cached.textureHeight, camera)) {
+			return;
+		}
+
+		SDL_Texture *texture = cached.IsStale(textLabel) ? nullptr : assetStore->GetTextTexture(cached.textureHandle);
+		if (!texture) {
+			assetStore->RemoveTextTexture(cached.textureHandle);
+			cached.textureHandle = assetStore->AddTextTexture(
+				renderer,
+				textLabel.assetId,
+				textLabel.text,
+				textLabel.color,
+				cached.textureWidth,
+				cached.textureHeight
+			);
+			cached.text = textLabel.text;
+			cached.assetId = textLabel.assetId;
+			cached.color = textLabel.color;
+			texture = assetStore->GetTextTexture(cached.textureHandle);
+			if (!texture) {
+				return;
+			}
+		}
+
+		SDL_Rect dstRect = {
+			static_cast<int>(textLabel.position.x - (textLabel.isFixed ? 0 : camera.x)),
+			static_cast<int>(textLabel.position.y - (textLabel.isFixed ? 0 : camera.y)),
+			cached.textureWidth,
+			cached.textureHeight
+		};
+		textBatcher.Flush();
+		SDL_RenderCopy(renderer, texture, NULL, &dstRect);
+	}
+
 public:
 	RenderTextSystem() {
 		RequireComponent<TextLabelComponent>();
 	}
 
-	void Update(SDL_Renderer *renderer, SDL_Rect camera, std::unique_ptr<AssetStore> &assetStore) {
+	void Extract(RenderSnapshot &snapshot) {
 		for (auto entity: GetSystemEntities()) {
-			const auto textLabel = entity.GetComponent<TextLabelComponent>();
-			SDL_Surface *surface = TTF_RenderText_Blended(
-				assetStore->GetFont(textLabel.assetId),
-				textLabel.text.c_str(),
-				textLabel.color
-			);
-			SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-			SDL_FreeSurface(surface);
+			const auto &textLabel = entity.GetComponent<TextLabelComponent>();
+			snapshot.textLabels.push_back({
+				static_cast<size_t>(entity.GetId()),
+				textLabel.position,
+				textLabel.text,
+				textLabel.assetId,
+				textLabel.color,
+				textLabel.isFixed,
+				textLabel.isCached
+			});
+		}
+	}
+
+	void Draw(SDL_Renderer *renderer, const RenderSnapshot &snapshot, const std::unique_ptr<AssetStore> &assetStore) {
+		const SDL_Rect camera = snapshot.InterpolatedCamera();
+		textBatcher.Begin(renderer);
 
-			int labelWidth = 0;
-			int labelHeight = 0;
-			SDL_QueryTexture(texture, NULL, NULL, &labelWidth, &labelHeight);
+		for (const auto &textLabel: snapshot.textLabels) {
+			if (textLabel.isCached) {
+				drawCached(renderer, camera, assetStore, textLabel);
+				continue;
+			}
 
-			SDL_Rect dstRect = {
+			GlyphAtlas *font = assetStore->GetGlyphAtlas(textLabel.assetId);
+			if (!font) {
+				continue;
+			}
+
+			if (!textLabel.isFixed) {
+				const TextLayout &layout = font->Layout(textLabel.text);
+				if (isOutView(textLabel, layout.width, layout.height, camera)) {
+					continue;
+				}
+			}
+
+			textBatcher.Draw(
+				*font,
+				textLabel.text,
 				static_cast<int>(textLabel.position.x - (textLabel.isFixed ? 0 : camera.x)),
 				static_cast<int>(textLabel.position.y - (textLabel.isFixed ? 0 : camera.y)),
-				labelWidth,
-				labelHeight
-			};
-			SDL_RenderCopy(renderer, texture, NULL, &dstRect);
-
-			SDL_DestroyTexture(texture);
+				{textLabel.color.r, textLabel.color.g, textLabel.color.b, 255}
+			);
 		}
+
+		textBatcher.End();
 	}
 };
 
@@ -1,4 +1,5 @@
 #include "ScriptSystem.h"
+#include "VisibilitySystem.h"
 
 std::tuple<double, double> GetEntityPosition(Entity entity) {
     if (!entity.HasComponent<TransformComponent>()) {
@@ -26,6 +27,9 @@ void SetEntityPosition(Entity entity, double x, double y) {
     auto& transform = entity.GetComponent<TransformComponent>();
     transform.position.x = x;
     transform.position.y = y;
+    if (entity.entityManager->HasSystem<VisibilitySystem>()) {
+	entity.entityManager->GetSystem<VisibilitySystem>().MarkChanged(entity);
+    }
 }
 
 void SetEntityVelocity(Entity entity, double x, double y) {
@@ -65,3 +69,71 @@ void SetProjectileVelocity(Entity entity, double x, double y) {
     projectileEmitter.projectileVelocity.x = x;
     projectileEmitter.projectileVelocity.y = y;
 }
+
+// Queues a burst of count particles, or the emitter's own burst count, for the next step.
+void EmitParticles(Entity entity, sol::optional<int> count) {
+    if (!entity.HasComponent<ParticleEmitterComponent>()) {
+        Logger::Err("Trying to emit particles from an entity that has no particle emitter component");
+	return;
+    }
+    auto& emitter = entity.GetComponent<ParticleEmitterComponent>();
+    emitter.pendingBurst += count.value_or(emitter.burstCount);
+}
+
+void SetParticleRate(Entity entity, double rate) {
+    if (!entity.HasComponent<ParticleEmitterComponent>()) {
+        Logger::Err("Trying to set the particle rate of an entity that has no particle emitter component");
+	return;
+    }
+    auto& emitter = entity.GetComponent<ParticleEmitterComponent>();
+    emitter.rate = rate;
+}
+
+// Fills the caller's table when one is passed in, so scripts that query every frame can keep reusing it.
+static sol::table entitiesToTable(sol::this_state state, const std::vector<Entity> &entities, sol::optional<sol::table> results) {
+    sol::state_view lua(state);
+    sol::table table = results ? *results : lua.create_table(static_cast<int>(entities.size()), 0);
+    for (size_t i = 0; i < entities.size(); i++) {
+        table[i + 1] = entities[i];
+    }
+    for (size_t i = entities.size() + 1; table[i] != sol::lua_nil; i++) {
+        table[i] = sol::lua_nil;
+    }
+    return table;
+}
+
+void CreateSpatialQueryBindings(sol::state &lua, SpatialQuery &spatialQuery) {
+    lua.set_function("query_aabb", [&spatialQuery](sol::this_state state, double x, double y, double w, double h, sol::optional<sol::table> results) {
+        const AABB area = {
+            static_cast<float>(x),
+            static_cast<float>(y),
+            static_cast<float>(x + w),
+            static_cast<float>(y + h)
+        };
+        return entitiesToTable(state, spatialQuery.QueryAABB(area), results);
+    });
+
+    lua.set_function("query_radius", [&spatialQuery](sol::this_state state, double x, double y, double radius, sol::optional<sol::table> results) {
+        const auto &entities = spatialQuery.QueryRadius(glm::vec2(x, y), static_cast<float>(radius));
+        return entitiesToTable(state, entities, results);
+    });
+
+    lua.set_function("nearest", [&spatialQuery](sol::this_state state, double x, double y, int k, sol::optional<std::string> group, sol::optional<sol::table> results) {
+        if (k <= 0) {
+            Logger::Err("nearest expects a positive number of entities to find");
+            return entitiesToTable(state, std::vector<Entity>(), results);
+        }
+        const auto &entities = spatialQuery.Nearest(glm::vec2(x, y), static_cast<size_t>(k), group.value_or(""));
+        return entitiesToTable(state, entities, results);
+    });
+
+    lua.set_function("raycast", [&spatialQuery](sol::this_state state, double x, double y, double dx, double dy, double maxDistance, sol::optional<Entity> ignore) {
+        RaycastHit hit;
+        const int ignoreEntityId = ignore ? ignore->GetId() : -1;
+        if (!spatialQuery.Raycast(glm::vec2(x, y), glm::vec2(dx, dy), static_cast<float>(maxDistance), hit, ignoreEntityId)) {
+            return std::make_tuple(sol::object(sol::lua_nil), 0.0, 0.0, 0.0);
+        }
+        sol::object entity = sol::make_object(state.lua_state(), hit.entity);
+        return std::make_tuple(entity, static_cast<double>(hit.distance), static_cast<double>(hit.point.x), static_cast<double>(hit.point.y));
+    });
+}
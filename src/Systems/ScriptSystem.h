@@ -8,6 +8,8 @@
 #include "../Components/AnimationComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/ProjectileEmitterComponent.h"
+#include "../Components/ParticleEmitterComponent.h"
+#include "../Collision/SpatialQuery.h"
 
 std::tuple<double, double> GetEntityPosition(Entity entity);
 std::tuple<double, double> GetEntityVelocity(Entity entity);
@@ -16,6 +18,9 @@ void SetEntityVelocity(Entity entity, double x, double y);
 void SetEntityRotation(Entity entity, double angle);
 void SetEntityAnimationFrame(Entity entity, int frame);
 void SetProjectileVelocity(Entity entity, double x, double y);
+void EmitParticles(Entity entity, sol::optional<int> count);
+void SetParticleRate(Entity entity, double rate);
+void CreateSpatialQueryBindings(sol::state &lua, SpatialQuery &spatialQuery);
 
 class ScriptSystem: public System {
 public:
@@ -23,7 +28,7 @@ public:
 		RequireComponent<ScriptComponent>();
 	}
 
-	void CreateScriptBindings(sol::state &lua) {
+	void CreateScriptBindings(sol::state &lua, SpatialQuery &spatialQuery) {
 		lua.new_usertype<Entity>(
 				"entity",
 				"get_id", &Entity::GetId,
@@ -39,6 +44,10 @@ public:
             lua.set_function("set_rotation", SetEntityRotation);
             lua.set_function("set_projectile_velocity", SetProjectileVelocity);
             lua.set_function("set_animation_frame", SetEntityAnimationFrame);
+            lua.set_function("emit_particles", EmitParticles);
+            lua.set_function("set_particle_rate", SetParticleRate);
+
+            CreateSpatialQueryBindings(lua, spatialQuery);
 	}
 
 	void Update(double dt, int ellapsedTime) {
@@ -0,0 +1,295 @@
+#ifndef VISIBILITY_SYSTEM_H
+#define VISIBILITY_SYSTEM_H
+
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+#include <SDL2/SDL.h>
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/HealthComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/ScriptComponent.h"
+#include "../Collision/AABB.h"
+
+// Works out which entities are on screen once per frame, for all the render systems. Entities are kept in a
+// sparse grid of world cells, and only the cells overlapping the camera are looked at, so the cost follows what's
+// on screen rather than the size of the world.
+//
+// Entities that can move on their own (rigid body or script) are re-binned every frame; all others are binned
+// once when they're added, and again after MarkChanged. Fixed (screen space) sprites are always visible.
+class VisibilitySystem : public System {
+private:
+	static constexpr float CELL_SIZE = 256.0f;
+	// The health bar and its label are drawn to the right of the sprite.
+	static constexpr float HEALTH_BAR_WIDTH = 48.0f;
+	static constexpr float HEALTH_BAR_HEIGHT = 16.0f;
+
+	enum Kind {
+		HIDDEN,
+		STATIC,
+		DYNAMIC,
+		FIXED
+	};
+
+	struct CellRange {
+		int minCol;
+		int minRow;
+		int maxCol;
+		int maxRow;
+
+		bool operator ==(const CellRange &other) const {
+			return minCol == other.minCol && minRow == other.minRow && maxCol == other.maxCol && maxRow == other.maxRow;
+		}
+	};
+
+	struct Record {
+		Kind kind;
+		AABB bounds;
+		CellRange cells;
+		size_t listIdx;
+	};
+
+	std::unordered_map<uint64_t, std::vector<Entity>> cells;
+	std::vector<Record> records;
+	std::vector<Entity> dynamicEntities;
+	std::vector<Entity> fixedEntities;
+	std::vector<Entity> changedEntities;
+	std::vector<Entity> rebinning;
+
+	std::vector<uint64_t> visibleMask;
+	std::vector<Entity> visibleEntities;
+
+	static uint64_t cellKey(int col, int row) {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(col)) << 32) | static_cast<uint32_t>(row);
+	}
+
+	static CellRange cellRange(const AABB &bounds) {
+		return {
+			static_cast<int>(std::floor(bounds.minX / CELL_SIZE)),
+			static_cast<int>(std::floor(bounds.minY / CELL_SIZE)),
+			static_cast<int>(std::floor(bounds.maxX / CELL_SIZE)),
+			static_cast<int>(std::floor(bounds.maxY / CELL_SIZE))
+		};
+	}
+
+	// Returns false for entities that nothing draws in world space.
+	static bool computeBounds(Entity entity, AABB &bounds, bool &isFixed) {
+		const auto &transform = entity.GetComponent<TransformComponent>();
+		bool hasBounds = false;
+		isFixed = false;
+
+		if (entity.HasComponent<SpriteComponent>()) {
+			const auto &sprite = entity.GetComponent<SpriteComponent>();
+			if (sprite.isFixed) {
+				isFixed = true;
+				return true;
+			}
+			bounds.minX = transform.position.x;
+			bounds.minY = transform.position.y;
+			bounds.maxX = transform.position.x + sprite.width * transform.scale.x;
+			bounds.maxY = transform.position.y + sprite.height * transform.scale.y;
+			if (entity.HasComponent<HealthComponent>()) {
+				bounds.maxX += HEALTH_BAR_WIDTH;
+				bounds.maxY = std::max(bounds.maxY, bounds.minY + HEALTH_BAR_HEIGHT);
+			}
+			hasBounds = true;
+		}
+
+		if (entity.HasComponent<BoxColliderComponent>()) {
+			const AABB box = GetColliderBounds(transform, entity.GetComponent<BoxColliderComponent>());
+			if (hasBounds) {
+				bounds.minX = std::min(bounds.minX, box.minX);
+				bounds.minY = std::min(bounds.minY, box.minY);
+				bounds.maxX = std::max(bounds.maxX, box.maxX);
+				bounds.maxY = std::max(bounds.maxY, box.maxY);
+			} else {
+				bounds = box;
+			}
+			hasBounds = true;
+		}
+
+		// Frames are drawn part way between the previous and current position, so the bounds cover both.
+		const glm::vec2 shift = transform.previousPosition - transform.position;
+		bounds.minX += std::min(shift.x, 0.0f);
+		bounds.minY += std::min(shift.y, 0.0f);
+		bounds.maxX += std::max(shift.x, 0.0f);
+		bounds.maxY += std::max(shift.y, 0.0f);
+
+		return hasBounds;
+	}
+
+	void bin(Entity entity, Record &record) {
+		for (int row = record.cells.minRow; row <= record.cells.maxRow; row++) {
+			for (int col = record.cells.minCol; col <= record.cells.maxCol; col++) {
+				cells[cellKey(col, row)].push_back(entity);
+			}
+		}
+	}
+
+	void unbin(Entity entity, const Record &record) {
+		for (int row = record.cells.minRow; row <= record.cells.maxRow; row++) {
+			for (int col = record.cells.minCol; col <= record.cells.maxCol; col++) {
+				std::vector<Entity> &cell = cells[cellKey(col, row)];
+				for (size_t i = 0; i < cell.size(); i++) {
+					if (cell[i] == entity) {
+						cell[i] = cell.back();
+						cell.pop_back();
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	void rebin(Entity entity, Record &record) {
+		bool isFixed;
+		AABB bounds;
+		if (!computeBounds(entity, bounds, isFixed) || isFixed) {
+			return;
+		}
+		record.bounds = bounds;
+
+		const CellRange range = cellRange(bounds);
+		if (range == record.cells) {
+			return;
+		}
+		unbin(entity, record);
+		record.cells = range;
+		bin(entity, record);
+	}
+
+	static void removeFromList(std::vector<Entity> &list, std::vector<Record> &records, size_t idx) {
+		list[idx] = list.back();
+		records[list[idx].GetId()].listIdx = idx;
+		list.pop_back();
+	}
+
+	void markVisible(Entity entity) {
+		const size_t entityId = entity.GetId();
+		visibleMask[entityId / 64] |= uint64_t(1) << (entityId % 64);
+		visibleEntities.push_back(entity);
+	}
+
+protected:
+	void OnEntityAdded(Entity entity) override {
+		const size_t entityId = entity.GetId();
+		if (entityId >= records.size()) {
+			records.resize(entityId + 1);
+			visibleMask.resize(entityId / 64 + 1, 0);
+		}
+
+		Record &record = records[entityId];
+		bool isFixed;
+		if (!computeBounds(entity, record.bounds, isFixed)) {
+			record.kind = HIDDEN;
+			return;
+		}
+		if (isFixed) {
+			record.kind = FIXED;
+			record.listIdx = fixedEntities.size();
+			fixedEntities.push_back(entity);
+			return;
+		}
+
+		record.cells = cellRange(record.bounds);
+		bin(entity, record);
+		if (entity.HasComponent<RigidBodyComponent>() || entity.HasComponent<ScriptComponent>()) {
+			record.kind = DYNAMIC;
+			record.listIdx = dynamicEntities.size();
+			dynamicEntities.push_back(entity);
+		} else {
+			record.kind = STATIC;
+		}
+	}
+
+	void OnEntityRemoved(Entity entity) override {
+		Record &record = records[entity.GetId()];
+		if (record.kind == FIXED) {
+			removeFromList(fixedEntities, records, record.listIdx);
+		} else if (record.kind != HIDDEN) {
+			unbin(entity, record);
+			if (record.kind == DYNAMIC) {
+				removeFromList(dynamicEntities, records, record.listIdx);
+			}
+		}
+		record.kind = HIDDEN;
+		visibleMask[entity.GetId() / 64] &= ~(uint64_t(1) << (entity.GetId() % 64));
+	}
+
+public:
+	VisibilitySystem() {
+		RequireComponent<TransformComponent>();
+	}
+
+	// Static entities must be marked when their position, scale or sprite size is changed from outside the
+	// systems that move things, e.g. by a script calling set_position on another entity.
+	void MarkChanged(Entity entity) {
+		changedEntities.push_back(entity);
+	}
+
+	bool IsVisible(Entity entity) const {
+		const size_t entityId = entity.GetId();
+		return entityId / 64 < visibleMask.size() && (visibleMask[entityId / 64] >> (entityId % 64)) & 1;
+	}
+
+	const std::vector<Entity> &GetVisibleEntities() const {
+		return visibleEntities;
+	}
+
+	void Update(const SDL_Rect &camera) {
+		for (auto entity: visibleEntities) {
+			visibleMask[entity.GetId() / 64] = 0;
+		}
+		visibleEntities.clear();
+
+		for (auto entity: dynamicEntities) {
+			rebin(entity, records[entity.GetId()]);
+		}
+
+		// The bounds cover the move from the previous position, so a moved static entity is binned again on the
+		// next frame too, once its previous position has caught up.
+		std::swap(rebinning, changedEntities);
+		changedEntities.clear();
+		for (auto entity: rebinning) {
+			const size_t entityId = entity.GetId();
+			if (entityId >= records.size() || records[entityId].kind != STATIC) {
+				continue;
+			}
+			rebin(entity, records[entityId]);
+			const auto &transform = entity.GetComponent<TransformComponent>();
+			if (transform.previousPosition != transform.position) {
+				changedEntities.push_back(entity);
+			}
+		}
+
+		for (auto entity: fixedEntities) {
+			markVisible(entity);
+		}
+
+		const AABB view = {
+			static_cast<float>(camera.x),
+			static_cast<float>(camera.y),
+			static_cast<float>(camera.x + camera.w),
+			static_cast<float>(camera.y + camera.h)
+		};
+		const CellRange range = cellRange(view);
+		for (int row = range.minRow; row <= range.maxRow; row++) {
+			for (int col = range.minCol; col <= range.maxCol; col++) {
+				auto cell = cells.find(cellKey(col, row));
+				if (cell == cells.end()) {
+					continue;
+				}
+				for (auto entity: cell->second) {
+					if (!IsVisible(entity) && AABBOverlaps(records[entity.GetId()].bounds, view)) {
+						markVisible(entity);
+					}
+				}
+			}
+		}
+	}
+};
+
+#endif // VISIBILITY_SYSTEM_H
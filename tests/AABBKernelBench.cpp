@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../src/Collision/AABBKernel.h"
+
+// Times each overlap kernel testing one box against batches of candidates of the sizes a broadphase cell
+// typically holds.
+
+typedef void (*OverlapBatchFunc)(const AABB&, const float*, const float*, const float*, const float*, size_t, uint8_t*);
+
+static double nanosecondsPerBox(OverlapBatchFunc func, const AABBArray &boxes, const std::vector<AABB> &probes) {
+	const size_t count = boxes.Size();
+	std::vector<uint8_t> hitMasks((count + 7) / 8);
+	const size_t numTests = 2000000;
+	const size_t numCalls = numTests / count + 1;
+
+	unsigned checksum = 0;
+	double best = 1e30;
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t call = 0; call < numCalls; call++) {
+			func(probes[call % probes.size()], boxes.minX.data(), boxes.minY.data(), boxes.maxX.data(), boxes.maxY.data(), count, hitMasks.data());
+			checksum += hitMasks[0];
+		}
+		const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count() / (numCalls * count));
+	}
+	// Keeps the calls from being optimised away.
+	if (checksum == 1) {
+		printf(" ");
+	}
+	return best;
+}
+
+int main() {
+	std::mt19937 rng(26);
+	std::uniform_real_distribution<float> position(0.0f, 1000.0f);
+	std::uniform_real_distribution<float> size(4.0f, 64.0f);
+
+	std::vector<AABB> probes;
+	for (int i = 0; i < 64; i++) {
+		const float x = position(rng), y = position(rng);
+		probes.push_back({x, y, x + size(rng), y + size(rng)});
+	}
+
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	const bool hasAVX2 = __builtin_cpu_supports("avx2");
+#else
+	const bool hasAVX2 = false;
+#endif
+
+	printf("dispatch selects %s\n", OverlapBatchKernelName());
+	printf("%8s %12s %12s %12s\n", "boxes", "scalar ns", "sse2 ns", "avx2 ns");
+	for (size_t count: {7, 8, 16, 33, 64, 256, 1024}) {
+		AABBArray boxes;
+		for (size_t i = 0; i < count; i++) {
+			const float x = position(rng), y = position(rng);
+			boxes.Add({x, y, x + size(rng), y + size(rng)});
+		}
+		const double scalar = nanosecondsPerBox(OverlapBatchScalar, boxes, probes);
+		const double sse2 = nanosecondsPerBox(OverlapBatchSSE2, boxes, probes);
+		if (hasAVX2) {
+			const double avx2 = nanosecondsPerBox(OverlapBatchAVX2, boxes, probes);
+			printf("%8zu %12.3f %12.3f %12.3f\n", count, scalar, sse2, avx2);
+		} else {
+			printf("%8zu %12.3f %12.3f %12s\n", count, scalar, sse2, "n/a");
+		}
+	}
+	return 0;
+}
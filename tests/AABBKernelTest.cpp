@@ -0,0 +1,152 @@
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "../src/Collision/AABBKernel.h"
+#include "../src/Collision/Broadphase.h"
+
+// Checks every overlap kernel against the scalar path and AABBOverlaps on random boxes, and the broadphase grid
+// against a brute force pass. Returns non-zero on the first mismatch.
+
+static const uint8_t GUARD = 0xA5;
+
+static bool supportsAVX2() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#else
+	return true;
+#endif
+}
+
+// Whole number coordinates so that boxes often share an edge, which must not count as an overlap.
+static void randomBoxes(std::mt19937 &rng, size_t count, AABBArray &boxes) {
+	std::uniform_int_distribution<int> position(-200, 200);
+	std::uniform_int_distribution<int> size(0, 60);
+	boxes.Clear();
+	for (size_t i = 0; i < count; i++) {
+		const float x = static_cast<float>(position(rng));
+		const float y = static_cast<float>(position(rng));
+		boxes.Add({x, y, x + size(rng), y + size(rng)});
+	}
+}
+
+static bool checkKernels(const AABB &box, const AABBArray &boxes, bool hasAVX2) {
+	const size_t count = boxes.Size();
+	const size_t numBytes = (count + 7) / 8;
+
+	std::vector<uint8_t> expected(numBytes, 0);
+	for (size_t i = 0; i < count; i++) {
+		if (AABBOverlaps(box, boxes.Get(i))) {
+			expected[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+		}
+	}
+
+	struct Kernel {
+		const char *name;
+		void (*func)(const AABB&, const float*, const float*, const float*, const float*, size_t, uint8_t*);
+	};
+	std::vector<Kernel> kernels = {{"scalar", OverlapBatchScalar}, {"sse2", OverlapBatchSSE2}, {"dispatch", OverlapBatch}};
+	if (hasAVX2) {
+		kernels.push_back({"avx2", OverlapBatchAVX2});
+	}
+
+	for (const auto &kernel: kernels) {
+		// One byte past the end catches kernels that write more masks than the count needs.
+		std::vector<uint8_t> hitMasks(numBytes + 1, GUARD);
+		kernel.func(box, boxes.minX.data(), boxes.minY.data(), boxes.maxX.data(), boxes.maxY.data(), count, hitMasks.data());
+		if (hitMasks[numBytes] != GUARD) {
+			printf("FAIL %s wrote past the hit masks for %zu boxes\n", kernel.name, count);
+			return false;
+		}
+		hitMasks.pop_back();
+		if (hitMasks != expected) {
+			printf("FAIL %s disagrees with the scalar path for %zu boxes\n", kernel.name, count);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool checkBroadphase(const AABBArray &boxes, float cellSize) {
+	std::set<std::pair<uint32_t, uint32_t>> expected;
+	for (uint32_t i = 0; i < boxes.Size(); i++) {
+		for (uint32_t j = i + 1; j < boxes.Size(); j++) {
+			if (AABBOverlaps(boxes.Get(i), boxes.Get(j))) {
+				expected.insert({i, j});
+			}
+		}
+	}
+
+	Broadphase broadphase(cellSize);
+	broadphase.Build(boxes);
+	std::set<std::pair<uint32_t, uint32_t>> found;
+	for (size_t cell = 0; cell < broadphase.NumCells(); cell++) {
+		size_t count;
+		const uint32_t *items = broadphase.GetCellItems(cell, count);
+		for (size_t i = 0; i < count; i++) {
+			for (size_t j = i + 1; j < count; j++) {
+				const AABB a = boxes.Get(items[i]);
+				const AABB b = boxes.Get(items[j]);
+				if (!AABBOverlaps(a, b) || !broadphase.OwnsPair(cell, a, b)) {
+					continue;
+				}
+				const std::pair<uint32_t, uint32_t> pair(std::min(items[i], items[j]), std::max(items[i], items[j]));
+				if (!found.insert(pair).second) {
+					printf("FAIL broadphase reported pair %u %u twice\n", pair.first, pair.second);
+					return false;
+				}
+			}
+		}
+	}
+	if (found != expected) {
+		printf("FAIL broadphase found %zu pairs, brute force %zu\n", found.size(), expected.size());
+		return false;
+	}
+	return true;
+}
+
+int main() {
+	const bool hasAVX2 = supportsAVX2();
+	std::mt19937 rng(26);
+	AABBArray boxes;
+
+	// Every count up to a few SIMD widths, so each tail length is covered, then some larger ones.
+	std::vector<size_t> counts;
+	for (size_t count = 0; count <= 67; count++) {
+		counts.push_back(count);
+	}
+	for (size_t count: {127, 128, 129, 255, 1000, 1021}) {
+		counts.push_back(count);
+	}
+
+	size_t numChecks = 0;
+	for (size_t count: counts) {
+		for (int round = 0; round < 20; round++) {
+			randomBoxes(rng, count, boxes);
+			AABBArray probe;
+			randomBoxes(rng, 1, probe);
+			if (!checkKernels(probe.Get(0), boxes, hasAVX2)) {
+				return 1;
+			}
+			for (size_t i = 0; i < std::min<size_t>(count, 4); i++) {
+				if (!checkKernels(boxes.Get(i), boxes, hasAVX2)) {
+					return 1;
+				}
+			}
+			numChecks++;
+		}
+	}
+
+	for (int round = 0; round < 50; round++) {
+		randomBoxes(rng, 1 + rng() % 300, boxes);
+		if (!checkBroadphase(boxes, round % 2 ? 64.0f : 8.0f)) {
+			return 1;
+		}
+	}
+
+	printf("AABBKernelTest passed: %zu kernel checks (%s%s), 50 broadphase checks\n", numChecks, OverlapBatchKernelName(), hasAVX2 ? ", avx2 tested" : ", avx2 not supported here");
+	return 0;
+}
@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <memory>
+#include "../src/Systems/AnimationSystem.h"
+
+// Steps 100000 animated sprites at 60 Hz through the original AnimationSystem, which works out every sprite's frame
+// every step, and the current one, which only touches the sprites whose frame changes. The first scene mixes clips
+// like the levels' (mostly 2 frames at 2 or 10 fps), the second has clips of 4 to 16 frames at 6 to 24 fps, so a
+// quarter of the sprites change frame every step. Both systems must end every sprite on the same source rect.
+
+Uint32 Clock::ticks = 0;
+
+// The AnimationSystem as it was before next-frame deadlines, kept here to measure against.
+namespace Baseline {
+	class AnimationSystem : public System {
+	public:
+		AnimationSystem() {
+			RequireComponent<SpriteComponent>();
+			RequireComponent<AnimationComponent>();
+		}
+
+		void Update() {
+			for (auto entity: GetSystemEntities()) {
+				auto &animation = entity.GetComponent<AnimationComponent>();
+				auto &sprite = entity.GetComponent<SpriteComponent>();
+
+				animation.currentFrame = ((Clock::GetTicks() - animation.startTime) * animation.frameRateSpeed / 1000) % animation.numFrames;
+				sprite.srcRect.x = animation.currentFrame * sprite.width;
+			}
+		}
+	};
+}
+
+static const int NUM_SPRITES = 100000;
+static const int NUM_STEPS = 600;
+
+struct ClipShape {
+	int numFrames;
+	int frameRateSpeed;
+};
+
+struct Scene {
+	EntityManager entityManager;
+	std::vector<Entity> entities;
+
+	Scene(bool isFast) {
+		// Frame counts and rates the level scripts use, weighted by how often they use them.
+		const ClipShape levelClips[] = {{2, 10}, {2, 10}, {2, 10}, {2, 10}, {2, 10}, {2, 2}, {2, 2}, {2, 2}, {3, 7}, {8, 15}};
+		std::mt19937 rng(49);
+		for (int i = 0; i < NUM_SPRITES; i++) {
+			const ClipShape clip = isFast ? ClipShape{4 + static_cast<int>(rng() % 13), 6 + static_cast<int>(rng() % 19)} : levelClips[rng() % 10];
+			Clock::SetTicks(rng() % 1000);
+			Entity entity = entityManager.CreateEntity();
+			entity.AddComponent<SpriteComponent>("sheet", 32, 32);
+			entity.AddComponent<AnimationComponent>(clip.numFrames, clip.frameRateSpeed);
+			entities.push_back(entity);
+		}
+	}
+};
+
+static Uint32 stepTicks(int step) {
+	return 1000 + static_cast<Uint32>(step * 1000 / 60);
+}
+
+// Returns the old and new milliseconds per step, or a negative time if the systems disagree.
+static std::pair<double, double> runScenes(bool isFast) {
+	Scene oldScene(isFast);
+	oldScene.entityManager.AddSystem<Baseline::AnimationSystem>();
+	oldScene.entityManager.Update();
+
+	Scene newScene(isFast);
+	newScene.entityManager.AddSystem<AnimationSystem>();
+	newScene.entityManager.Update();
+	auto eventBus = std::make_unique<EventBus>();
+
+	auto start = std::chrono::steady_clock::now();
+	for (int step = 0; step < NUM_STEPS; step++) {
+		Clock::SetTicks(stepTicks(step));
+		oldScene.entityManager.GetSystem<Baseline::AnimationSystem>().Update();
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	const double oldMilliseconds = elapsed.count() / NUM_STEPS;
+
+	start = std::chrono::steady_clock::now();
+	for (int step = 0; step < NUM_STEPS; step++) {
+		newScene.entityManager.GetSystem<AnimationSystem>().Update(stepTicks(step), eventBus);
+	}
+	elapsed = std::chrono::steady_clock::now() - start;
+	const double newMilliseconds = elapsed.count() / NUM_STEPS;
+
+	for (size_t i = 0; i < newScene.entities.size(); i++) {
+		if (oldScene.entities[i].GetComponent<SpriteComponent>().srcRect.x != newScene.entities[i].GetComponent<SpriteComponent>().srcRect.x) {
+			printf("FAIL sprite %zu ended on a different frame than with the old system\n", i);
+			return {-1, -1};
+		}
+	}
+	return {oldMilliseconds, newMilliseconds};
+}
+
+int main() {
+	printf("%d animated sprites, %d steps at 60 Hz\n", NUM_SPRITES, NUM_STEPS);
+	printf("%12s %12s %12s %10s\n", "clips", "old ms/step", "new ms/step", "speedup");
+	for (bool isFast: {false, true}) {
+		const auto milliseconds = runScenes(isFast);
+		if (milliseconds.first < 0) {
+			return 1;
+		}
+		printf("%12s %12.3f %12.3f %10.2f\n", isFast ? "6-24 fps" : "level mix", milliseconds.first, milliseconds.second, milliseconds.first / milliseconds.second);
+	}
+	return 0;
+}
@@ -0,0 +1,158 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "../src/Systems/AnimationSystem.h"
+
+// Steps random clips with uneven steps, often long enough to skip several frames, and checks every clip's frame and
+// source rect against working them out from the elapsed time. A step that crosses a clip's event frame, once or
+// several times, queues exactly one event for it, and every clip that doesn't loop queues exactly one finished
+// event. Some entities are removed midway.
+
+Uint32 Clock::ticks = 0;
+
+struct Expected {
+	Entity entity;
+	int32_t startTime;
+	int numFrames;
+	int frameRateSpeed;
+	bool isLoop;
+	int numColumns;
+	int eventFrame;
+	SDL_Rect origin;
+	bool isAlive;
+	// Frames shown since the start, without wrapping, as of the last step.
+	int frameCount;
+	int numEvents;
+	int numFinished;
+
+	int frameCountAt(int32_t ticks) const {
+		const int frameCount = ticks > startTime ? static_cast<int>((static_cast<int64_t>(ticks) - startTime) * frameRateSpeed / 1000) : 0;
+		return isLoop ? frameCount : std::min(frameCount, numFrames - 1);
+	}
+};
+
+struct EventLog {
+	std::vector<AnimationEvent> events;
+
+	void OnAnimation(AnimationEvent &event) {
+		events.push_back(event);
+	}
+};
+
+static bool runScene(unsigned seed, size_t &numChecks) {
+	std::mt19937 rng(seed);
+	EntityManager entityManager;
+	entityManager.AddSystem<AnimationSystem>();
+	auto eventBus = std::make_unique<EventBus>();
+	EventLog log;
+	eventBus->SubscribeToEvent<AnimationEvent, &EventLog::OnAnimation>(&log);
+
+	std::vector<Expected> clips;
+	for (int i = 0; i < 400; i++) {
+		const int numFrames = 1 + rng() % 12;
+		const int width = 8 + rng() % 32;
+		const int height = 8 + rng() % 32;
+		Expected clip = {
+			entityManager.CreateEntity(),
+			static_cast<int32_t>(rng() % 500),
+			numFrames,
+			i % 10 == 0 ? 1000 + static_cast<int>(rng() % 500) : 1 + static_cast<int>(rng() % 60),
+			rng() % 2 == 0,
+			static_cast<int>(rng() % 5),
+			static_cast<int>(rng() % (numFrames + 1)) - 1,
+			{static_cast<int>(rng() % 256), static_cast<int>(rng() % 256), width, height},
+			true,
+			0,
+			0,
+			0
+		};
+		Clock::SetTicks(clip.startTime);
+		clip.entity.AddComponent<SpriteComponent>("sheet", width, height, 0, false, clip.origin.x, clip.origin.y);
+		clip.entity.AddComponent<AnimationComponent>(numFrames, clip.frameRateSpeed, clip.isLoop, clip.numColumns, clip.eventFrame);
+		clips.push_back(clip);
+	}
+	entityManager.Update();
+
+	int32_t ticks = 500;
+	for (int step = 0; step < 300; step++) {
+		ticks += step % 3 == 0 ? 1 + rng() % 16 : rng() % 400;
+		if (step == 150) {
+			for (size_t i = 0; i < clips.size(); i += 3) {
+				clips[i].entity.Kill();
+				clips[i].isAlive = false;
+			}
+			entityManager.Update();
+		}
+
+		log.events.clear();
+		entityManager.GetSystem<AnimationSystem>().Update(static_cast<Uint32>(ticks), eventBus);
+		eventBus->DispatchQueuedEvents();
+		for (const auto &event: log.events) {
+			for (auto &clip: clips) {
+				if (clip.entity == event.entity) {
+					if (event.isFinished) {
+						clip.numFinished++;
+					} else {
+						clip.numEvents++;
+					}
+				}
+			}
+		}
+
+		for (auto &clip: clips) {
+			if (!clip.isAlive) {
+				continue;
+			}
+			const int frameCount = clip.frameCountAt(ticks);
+			const int frame = frameCount % clip.numFrames;
+			const int numColumns = clip.numColumns > 0 ? clip.numColumns : clip.numFrames;
+			const SDL_Rect &srcRect = clip.entity.GetComponent<SpriteComponent>().srcRect;
+			const int expectedX = clip.origin.x + frame % numColumns * clip.origin.w;
+			const int expectedY = clip.origin.y + frame / numColumns * clip.origin.h;
+			if (clip.entity.GetComponent<AnimationComponent>().currentFrame != frame || srcRect.x != expectedX || srcRect.y != expectedY) {
+				printf("FAIL seed %u clip %d at %d ms: frame %d at (%d, %d), expected frame %d at (%d, %d)\n", seed, clip.entity.GetId(), ticks,
+					clip.entity.GetComponent<AnimationComponent>().currentFrame, srcRect.x, srcRect.y, frame, expectedX, expectedY);
+				return false;
+			}
+
+			bool isEventCrossed = false;
+			for (int k = clip.frameCount + 1; k <= frameCount; k++) {
+				isEventCrossed |= k % clip.numFrames == clip.eventFrame;
+			}
+			if (clip.numEvents != (isEventCrossed ? 1 : 0)) {
+				printf("FAIL seed %u clip %d at %d ms: %d events for frames %d to %d, event frame %d of %d\n", seed, clip.entity.GetId(), ticks,
+					clip.numEvents, clip.frameCount + 1, frameCount, clip.eventFrame, clip.numFrames);
+				return false;
+			}
+			clip.frameCount = frameCount;
+			clip.numEvents = 0;
+			numChecks++;
+		}
+	}
+
+	for (const auto &clip: clips) {
+		if (!clip.isAlive) {
+			continue;
+		}
+		const int expectedFinished = clip.isLoop ? 0 : 1;
+		if (clip.numFinished != expectedFinished) {
+			printf("FAIL seed %u clip %d with %d frames at %d fps: %d finished events, expected %d\n", seed, clip.entity.GetId(), clip.numFrames,
+				clip.frameRateSpeed, clip.numFinished, expectedFinished);
+			return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	size_t numChecks = 0;
+	for (unsigned seed = 0; seed < 10; seed++) {
+		if (!runScene(seed, numChecks)) {
+			return 1;
+		}
+	}
+	printf("AnimationSystemTest passed: %zu checks\n", numChecks);
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <thread>
+#include <utility>
+#include "../src/Systems/CollisionSystem.h"
+
+// Steps the same scene of moving colliders through CollisionSystem with 1 thread, then 2, 4, ... up to the hardware
+// thread count, and reports the time per step against the single threaded run. Every run must send exactly the same
+// collision events.
+
+static const int NUM_ENTITIES = 20000;
+static const int NUM_STEPS = 30;
+static const float WORLD_SIZE = 8000.0f;
+
+struct ContactLog {
+	std::vector<std::pair<int, int>> events;
+
+	void OnEnter(CollisionEnterEvent &event) {
+		events.push_back({event.a.GetId(), event.b.GetId()});
+	}
+
+	void OnExit(CollisionExitEvent &event) {
+		events.push_back({-event.a.GetId() - 1, event.b.GetId()});
+	}
+};
+
+static double runScene(size_t numThreads, ContactLog &log) {
+	EntityManager entityManager;
+	entityManager.AddSystem<CollisionSystem>();
+	auto eventBus = std::make_unique<EventBus>();
+	auto threadPool = std::make_unique<ThreadPool>(numThreads);
+	eventBus->SubscribeToEvent<CollisionEnterEvent, &ContactLog::OnEnter>(&log);
+	eventBus->SubscribeToEvent<CollisionExitEvent, &ContactLog::OnExit>(&log);
+
+	std::mt19937 rng(29);
+	std::uniform_real_distribution<float> position(0.0f, WORLD_SIZE);
+	std::uniform_real_distribution<float> step(-6.0f, 6.0f);
+	std::vector<Entity> entities;
+	for (int i = 0; i < NUM_ENTITIES; i++) {
+		Entity entity = entityManager.CreateEntity();
+		entity.AddComponent<TransformComponent>(glm::vec2(position(rng), position(rng)));
+		entity.AddComponent<BoxColliderComponent>(32, 32);
+		entities.push_back(entity);
+	}
+	entityManager.Update();
+
+	double milliseconds = 0;
+	for (int i = 0; i < NUM_STEPS; i++) {
+		for (auto entity: entities) {
+			entity.GetComponent<TransformComponent>().position += glm::vec2(step(rng), step(rng));
+		}
+		const auto start = std::chrono::steady_clock::now();
+		entityManager.GetSystem<CollisionSystem>().Update(eventBus, threadPool);
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		milliseconds += elapsed.count();
+		eventBus->DispatchQueuedEvents();
+	}
+	return milliseconds / NUM_STEPS;
+}
+
+int main() {
+	const size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+	ContactLog expected;
+	const double baseline = runScene(1, expected);
+	printf("%zu colliders, %zu events over %d steps\n", static_cast<size_t>(NUM_ENTITIES), expected.events.size(), NUM_STEPS);
+	printf("%8s %12s %10s\n", "threads", "ms/step", "speedup");
+	printf("%8d %12.3f %10.2f\n", 1, baseline, 1.0);
+
+	std::vector<size_t> threadCounts;
+	for (size_t numThreads = 2; numThreads < maxThreads; numThreads *= 2) {
+		threadCounts.push_back(numThreads);
+	}
+	if (maxThreads > 1) {
+		threadCounts.push_back(maxThreads);
+	}
+
+	for (size_t numThreads: threadCounts) {
+		ContactLog log;
+		const double milliseconds = runScene(numThreads, log);
+		if (log.events != expected.events) {
+			printf("FAIL %zu threads sent different collision events than 1 thread\n", numThreads);
+			return 1;
+		}
+		printf("%8zu %12.3f %10.2f\n", numThreads, milliseconds, baseline / milliseconds);
+	}
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <memory>
+#include "../src/Systems/CollisionSystem.h"
+
+// Checks that fast colliders which pass through another collider within a single step are caught: one enter
+// event for the pair, with the time of impact of the first touch.
+
+struct EnterLog {
+	std::vector<CollisionEnterEvent> events;
+
+	void OnEnter(CollisionEnterEvent &event) {
+		events.push_back(event);
+	}
+};
+
+struct Scene {
+	EntityManager entityManager;
+	std::unique_ptr<EventBus> eventBus;
+	std::unique_ptr<ThreadPool> threadPool;
+	EnterLog log;
+
+	Scene(size_t numThreads): eventBus(std::make_unique<EventBus>()), threadPool(std::make_unique<ThreadPool>(numThreads)) {
+		entityManager.AddSystem<CollisionSystem>();
+		eventBus->SubscribeToEvent<CollisionEnterEvent, &EnterLog::OnEnter>(&log);
+		// Far away colliders, so the broadphase has more than one cell.
+		for (int i = 0; i < 300; i++) {
+			add(glm::vec2(4000 + (i % 20) * 40, 4000 + (i / 20) * 40), 32, 32, false);
+		}
+	}
+
+	Entity add(glm::vec2 position, int width, int height, bool isFast) {
+		Entity entity = entityManager.CreateEntity();
+		entity.AddComponent<TransformComponent>(position);
+		entity.AddComponent<BoxColliderComponent>(width, height, glm::vec2(0), isFast);
+		return entity;
+	}
+
+	void step() {
+		entityManager.Update();
+		entityManager.GetSystem<CollisionSystem>().Update(eventBus, threadPool);
+		eventBus->DispatchQueuedEvents();
+	}
+};
+
+static bool expectOneEnter(const char *name, const EnterLog &log, Entity a, Entity b, float timeOfImpact) {
+	if (log.events.size() != 1) {
+		printf("FAIL %s: %zu enter events, expected 1\n", name, log.events.size());
+		return false;
+	}
+	const CollisionEnterEvent &event = log.events[0];
+	const bool isPair = (event.a == a && event.b == b) || (event.a == b && event.b == a);
+	if (!isPair || std::fabs(event.timeOfImpact - timeOfImpact) > 1e-4f) {
+		printf("FAIL %s: enter between %d and %d at %f, expected %d and %d at %f\n", name, event.a.GetId(), event.b.GetId(), event.timeOfImpact, a.GetId(), b.GetId(), timeOfImpact);
+		return false;
+	}
+	return true;
+}
+
+// A 10x10 box moves 200 units through a wall 2 units thick, touching it once it has covered 90 of them.
+static bool thinWall(size_t numThreads) {
+	Scene scene(numThreads);
+	Entity mover = scene.add(glm::vec2(0, 0), 10, 10, true);
+	Entity wall = scene.add(glm::vec2(100, -50), 2, 110, false);
+	scene.step();
+
+	mover.GetComponent<TransformComponent>().position = glm::vec2(200, 0);
+	scene.step();
+	if (!expectOneEnter("thin wall", scene.log, mover, wall, 90.0f / 200.0f)) {
+		return false;
+	}
+
+	scene.log.events.clear();
+	mover.GetComponent<TransformComponent>().position = glm::vec2(400, 0);
+	scene.step();
+	if (!scene.log.events.empty()) {
+		printf("FAIL thin wall: enter events after the mover has passed\n");
+		return false;
+	}
+	return true;
+}
+
+// Two 32x32 movers cross mid-step. Neither end box is inside the other's swept bounds.
+static bool crossingMovers(size_t numThreads) {
+	Scene scene(numThreads);
+	Entity a = scene.add(glm::vec2(0, 0), 32, 32, true);
+	Entity b = scene.add(glm::vec2(500, -500), 32, 32, true);
+	scene.step();
+
+	a.GetComponent<TransformComponent>().position = glm::vec2(1000, 0);
+	b.GetComponent<TransformComponent>().position = glm::vec2(500, 500);
+	scene.step();
+	return expectOneEnter("crossing movers", scene.log, a, b, 468.0f / 1000.0f);
+}
+
+int main() {
+	for (size_t numThreads: {1, 4}) {
+		if (!thinWall(numThreads) || !crossingMovers(numThreads)) {
+			return 1;
+		}
+	}
+	printf("CollisionSweepTest passed\n");
+	return 0;
+}
@@ -0,0 +1,58 @@
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../src/EventBus/ConcurrentEventQueue.h"
+
+// Throughput of ConcurrentEventQueue with 1 to 16 producers pushing while one consumer drains.
+
+static const long EVENTS_PER_PRODUCER = 2000000;
+
+struct BenchEvent {
+	size_t producer;
+	long seq;
+
+	BenchEvent(size_t producer, long seq): producer(producer), seq(seq) {}
+};
+
+int main() {
+	printf("%10s %14s %12s\n", "producers", "events", "Mevents/s");
+	for (size_t numProducers = 1; numProducers <= 16; numProducers *= 2) {
+		ConcurrentEventQueue<BenchEvent> queue(numProducers);
+		std::atomic<size_t> numDone(0);
+		long numReceived = 0;
+		long checksum = 0;
+		auto consume = [&](BenchEvent &event) {
+			checksum += event.seq;
+			numReceived++;
+		};
+
+		const auto start = std::chrono::steady_clock::now();
+		std::vector<std::thread> producers;
+		for (size_t p = 0; p < numProducers; p++) {
+			producers.emplace_back([&, p]() {
+				for (long seq = 0; seq < EVENTS_PER_PRODUCER; seq++) {
+					queue.Push(p, p, seq);
+				}
+				numDone++;
+			});
+		}
+		while (numDone.load() < numProducers) {
+			queue.Drain(consume);
+		}
+		for (auto &producer: producers) {
+			producer.join();
+		}
+		queue.Drain(consume);
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		const long expected = static_cast<long>(numProducers) * EVENTS_PER_PRODUCER;
+		if (numReceived != expected || checksum != static_cast<long>(numProducers) * (EVENTS_PER_PRODUCER - 1) * EVENTS_PER_PRODUCER / 2) {
+			printf("FAIL %zu producers: received %ld of %ld events\n", numProducers, numReceived, expected);
+			return 1;
+		}
+		printf("%10zu %14ld %12.1f\n", numProducers, numReceived, numReceived / elapsed.count() / 1e6);
+	}
+	return 0;
+}
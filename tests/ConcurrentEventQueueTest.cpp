@@ -0,0 +1,140 @@
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include "../src/EventBus/EventBus.h"
+#include "../src/Jobs/ThreadPool.h"
+
+// Stress test for ConcurrentEventQueue, meant to be run under ThreadSanitizer with make tsan. Producers push while
+// the consumer drains, over several rounds so drained chunks are handed back and reused. Every event must arrive
+// once, in push order per producer, and be destroyed exactly once. The same is then checked through
+// EventBus::EmitEventConcurrent from a ThreadPool.
+
+static std::atomic<long> numLiveEvents(0);
+
+class StressEvent: public Event {
+public:
+	size_t producer;
+	long seq;
+	// Heap owned payload, so a lost or doubly destroyed event shows up as a leak or a bad free.
+	std::unique_ptr<long> payload;
+
+	StressEvent(size_t producer, long seq): producer(producer), seq(seq), payload(new long(seq)) {
+		numLiveEvents++;
+	}
+
+	StressEvent(StressEvent &&other): producer(other.producer), seq(other.seq), payload(std::move(other.payload)) {
+		numLiveEvents++;
+	}
+
+	StressEvent &operator =(StressEvent &&other) = default;
+
+	~StressEvent() {
+		numLiveEvents--;
+	}
+};
+
+static bool stressQueue(size_t numProducers, int numRounds, long eventsPerRound) {
+	ConcurrentEventQueue<StressEvent> queue(numProducers);
+	std::vector<long> nextSeq(numProducers, 0);
+	bool isInOrder = true;
+	long numReceived = 0;
+
+	auto consume = [&](StressEvent &event) {
+		if (event.producer >= numProducers || event.seq != nextSeq[event.producer] || !event.payload || *event.payload != event.seq) {
+			isInOrder = false;
+			return;
+		}
+		nextSeq[event.producer]++;
+		numReceived++;
+	};
+
+	for (int round = 0; round < numRounds; round++) {
+		std::atomic<size_t> numDone(0);
+		std::vector<std::thread> producers;
+		for (size_t p = 0; p < numProducers; p++) {
+			producers.emplace_back([&, p]() {
+				const long first = round * eventsPerRound;
+				for (long seq = first; seq < first + eventsPerRound; seq++) {
+					queue.Push(p, p, seq);
+				}
+				numDone++;
+			});
+		}
+		while (numDone.load() < numProducers) {
+			queue.Drain(consume);
+		}
+		for (auto &producer: producers) {
+			producer.join();
+		}
+		queue.Drain(consume);
+	}
+
+	const long expected = static_cast<long>(numProducers) * numRounds * eventsPerRound;
+	if (!isInOrder || numReceived != expected) {
+		printf("FAIL %zu producers: received %ld of %ld events%s\n", numProducers, numReceived, expected, isInOrder ? "" : ", out of order");
+		return false;
+	}
+
+	// Events left in the queue are destroyed with it.
+	queue.Push(0, 0, 0);
+	return true;
+}
+
+struct EventLog {
+	std::vector<long> received;
+
+	void OnEvent(StressEvent &event) {
+		received.push_back(event.seq);
+	}
+};
+
+static bool stressEventBus(size_t numThreads, int numFrames, long eventsPerFrame) {
+	auto eventBus = std::make_unique<EventBus>();
+	auto threadPool = std::make_unique<ThreadPool>(numThreads);
+	EventLog log;
+	eventBus->SubscribeToEvent<StressEvent, &EventLog::OnEvent>(&log);
+	eventBus->RegisterConcurrentEvent<StressEvent>(threadPool->NumThreads());
+
+	for (int frame = 0; frame < numFrames; frame++) {
+		log.received.clear();
+		// Events queued on the main thread come first, then the workers' in thread order.
+		eventBus->QueueEvent<StressEvent>(0, -1);
+		threadPool->ParallelFor(eventsPerFrame, [&](size_t begin, size_t end, size_t threadIdx) {
+			for (size_t seq = begin; seq < end; seq++) {
+				eventBus->EmitEventConcurrent<StressEvent>(threadIdx, threadIdx, static_cast<long>(seq));
+			}
+		});
+		eventBus->DispatchQueuedEvents();
+
+		bool isInOrder = log.received.size() == static_cast<size_t>(eventsPerFrame) + 1;
+		for (size_t i = 0; isInOrder && i < log.received.size(); i++) {
+			isInOrder = log.received[i] == static_cast<long>(i) - 1;
+		}
+		if (!isInOrder) {
+			printf("FAIL EventBus with %zu threads: frame %d received %zu events out of order\n", numThreads, frame, log.received.size());
+			return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	for (size_t numProducers: {1, 2, 4, 8, 16}) {
+		if (!stressQueue(numProducers, 8, 5000)) {
+			return 1;
+		}
+	}
+	for (size_t numThreads: {1, 2, 4, 8}) {
+		if (!stressEventBus(numThreads, 20, 3000)) {
+			return 1;
+		}
+	}
+	if (numLiveEvents.load() != 0) {
+		printf("FAIL %ld events were never destroyed\n", numLiveEvents.load());
+		return 1;
+	}
+	printf("ConcurrentEventQueueTest passed\n");
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../src/Systems/ParticleSystem.h"
+
+// Times the particle kernels over 200000 particles, then ParticleSystem::Update on a scene whose emitters keep about
+// 200000 particles alive, which has a budget of 2 ms per step. The update includes integration, removing dead
+// particles and emitting new ones.
+
+static const size_t NUM_PARTICLES = 200000;
+static const int NUM_STEPS = 300;
+static const int NUM_EMITTERS = 100;
+static const float STEP = 1.0f / 60.0f;
+
+typedef std::chrono::steady_clock Clock;
+
+template <typename TKernel>
+static double timeKernel(const ParticleBuffer &source, TKernel kernel) {
+	ParticleBuffer buffer = source;
+	double best = 1e30;
+	for (int run = 0; run < 5; run++) {
+		const auto start = Clock::now();
+		for (int step = 0; step < NUM_STEPS; step++) {
+			kernel(buffer, (buffer.count + 3) / 4 * 4, STEP);
+		}
+		const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+		best = std::min(best, elapsed.count() / NUM_STEPS);
+	}
+	return best;
+}
+
+int main() {
+	std::mt19937 rng(48);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	ParticleBuffer particles(NUM_PARTICLES);
+	for (size_t i = 0; i < NUM_PARTICLES; i++) {
+		particles.Add({
+			glm::vec2(unit(rng) * 2000, unit(rng) * 2000),
+			glm::vec2(unit(rng) * 100 - 50, unit(rng) * 100 - 50),
+			-30.0f,
+			1000.0f,
+			2.0f,
+			8.0f,
+			{255, 200, 80, 255},
+			{80, 80, 80, 0}
+		});
+	}
+	const double scalarMilliseconds = timeKernel(particles, IntegrateParticlesScalar);
+	const double sse2Milliseconds = timeKernel(particles, IntegrateParticlesSSE2);
+
+	// Each emitter spawns 2000 particles a second that live 1 second on average.
+	EntityManager entityManager;
+	entityManager.AddSystem<ParticleSystem>();
+	const float rate = static_cast<float>(NUM_PARTICLES) / NUM_EMITTERS;
+	for (int i = 0; i < NUM_EMITTERS; i++) {
+		Entity emitter = entityManager.CreateEntity();
+		emitter.AddComponent<TransformComponent>(glm::vec2(unit(rng) * 2000, unit(rng) * 2000));
+		emitter.AddComponent<ParticleEmitterComponent>(rate, 0, glm::vec2(0), -90.0f, 30.0f, 20.0f, 60.0f, 0.8f, 1.2f, -30.0f);
+	}
+	entityManager.Update();
+	ParticleSystem &particleSystem = entityManager.GetSystem<ParticleSystem>();
+	for (int step = 0; step < 120; step++) {
+		particleSystem.Update(STEP);
+	}
+
+	double updateMilliseconds = 0;
+	double numLive = 0;
+	for (int step = 0; step < NUM_STEPS; step++) {
+		const auto start = Clock::now();
+		particleSystem.Update(STEP);
+		const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+		updateMilliseconds += elapsed.count();
+		numLive += particleSystem.NumParticles();
+	}
+	updateMilliseconds /= NUM_STEPS;
+	numLive /= NUM_STEPS;
+
+	printf("%zu particles\n", NUM_PARTICLES);
+	printf("%22s %12s %12s\n", "", "ms/step", "ns/particle");
+	printf("%22s %12.3f %12.2f\n", "scalar kernel", scalarMilliseconds, scalarMilliseconds * 1e6 / NUM_PARTICLES);
+	printf("%22s %12.3f %12.2f\n", "sse2 kernel", sse2Milliseconds, sse2Milliseconds * 1e6 / NUM_PARTICLES);
+	printf("%22s %12.3f %12.2f\n", "ParticleSystem update", updateMilliseconds, updateMilliseconds * 1e6 / numLive);
+	printf("%.0f particles alive on average during the update, budget 2 ms: %s\n", numLive, updateMilliseconds <= 2.0 ? "met" : "missed");
+	return 0;
+}
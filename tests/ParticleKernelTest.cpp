@@ -0,0 +1,173 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "../src/Particles/ParticleBuffer.h"
+
+// Checks the SSE2 particle kernel against the scalar one, including counts that aren't a multiple of 4, and that
+// the padding lanes past the last particle never leak into live particles or into particles added later. Also
+// checks that removing dead particles by swapping in the last one leaves exactly the particles still alive.
+
+static std::vector<std::vector<float>*> arrays(ParticleBuffer &buffer) {
+	return {&buffer.posX, &buffer.posY, &buffer.velX, &buffer.velY, &buffer.gravity, &buffer.life, &buffer.size, &buffer.sizeRate,
+		&buffer.r, &buffer.g, &buffer.b, &buffer.a, &buffer.rRate, &buffer.gRate, &buffer.bRate, &buffer.aRate};
+}
+
+static ParticleSpawn randomSpawn(std::mt19937 &rng) {
+	std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> speed(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto color = [&rng]() {
+		return SDL_Color{static_cast<Uint8>(rng()), static_cast<Uint8>(rng()), static_cast<Uint8>(rng()), static_cast<Uint8>(rng())};
+	};
+	return {
+		glm::vec2(position(rng), position(rng)),
+		glm::vec2(speed(rng), speed(rng)),
+		speed(rng) / 4,
+		0.05f + unit(rng) * 2,
+		unit(rng) * 16,
+		unit(rng) * 16,
+		color(),
+		color()
+	};
+}
+
+// Both kernels do the same multiply and add per element, but a compiler may fuse the scalar one.
+static bool isClose(float a, float b) {
+	return std::fabs(a - b) <= 1e-5f * std::max(1.0f, std::fabs(a));
+}
+
+// Fills the padding lanes with values no live particle would have, so leaks show up.
+static void poisonPadding(ParticleBuffer &buffer) {
+	for (auto array: arrays(buffer)) {
+		std::fill(array->begin() + buffer.count, array->end(), 1e30f);
+	}
+}
+
+static bool kernelsMatch(std::mt19937 &rng, size_t numParticles) {
+	ParticleBuffer scalar(numParticles);
+	for (size_t i = 0; i < numParticles; i++) {
+		scalar.Add(randomSpawn(rng));
+	}
+	poisonPadding(scalar);
+	ParticleBuffer sse2 = scalar;
+
+	const size_t paddedCount = (numParticles + 3) / 4 * 4;
+	for (int step = 0; step < 10; step++) {
+		const float deltaTime = step % 2 == 0 ? 1.0f / 60.0f : 1.0f / 144.0f;
+		IntegrateParticlesScalar(scalar, numParticles, deltaTime);
+		IntegrateParticlesSSE2(sse2, paddedCount, deltaTime);
+	}
+
+	auto scalarArrays = arrays(scalar);
+	auto sse2Arrays = arrays(sse2);
+	for (size_t array = 0; array < scalarArrays.size(); array++) {
+		for (size_t i = 0; i < numParticles; i++) {
+			if (!isClose((*scalarArrays[array])[i], (*sse2Arrays[array])[i])) {
+				printf("FAIL %zu particles: array %zu particle %zu is %f with SSE2, %f scalar\n", numParticles, array, i, (*sse2Arrays[array])[i], (*scalarArrays[array])[i]);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Particles added into lanes the kernel has been running over as padding start from their spawn values.
+static bool paddingLanes(std::mt19937 &rng) {
+	ParticleBuffer buffer(5);
+	if (buffer.Capacity() % 4 != 0 || buffer.Capacity() < 5) {
+		printf("FAIL capacity %zu for 5 particles isn't padded to a multiple of 4\n", buffer.Capacity());
+		return false;
+	}
+	buffer.Add(randomSpawn(rng));
+	poisonPadding(buffer);
+	for (int step = 0; step < 30; step++) {
+		IntegrateParticles(buffer, (buffer.count + 3) / 4 * 4, 1.0f / 60.0f);
+	}
+
+	std::vector<ParticleSpawn> spawns;
+	while (buffer.count < buffer.Capacity()) {
+		spawns.push_back(randomSpawn(rng));
+		buffer.Add(spawns.back());
+	}
+	if (buffer.Add(randomSpawn(rng))) {
+		printf("FAIL a full buffer took another particle\n");
+		return false;
+	}
+	for (size_t i = 0; i < spawns.size(); i++) {
+		const ParticleSpawn &spawn = spawns[i];
+		const size_t idx = i + 1;
+		if (buffer.posX[idx] != spawn.position.x || buffer.posY[idx] != spawn.position.y || buffer.velY[idx] != spawn.velocity.y
+			|| buffer.life[idx] != spawn.lifetime || buffer.size[idx] != spawn.startSize || buffer.a[idx] != spawn.startColor.a) {
+			printf("FAIL particle added into padding lane %zu doesn't start from its spawn values\n", idx);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Each particle's startSize and endSize hold its id, so survivors can be told apart after being moved.
+static bool swapAndPop(std::mt19937 &rng, size_t numParticles) {
+	ParticleBuffer buffer(numParticles);
+	std::vector<float> expectedLife;
+	std::uniform_real_distribution<float> lifetime(0.01f, 0.5f);
+	for (size_t id = 0; id < numParticles; id++) {
+		ParticleSpawn spawn = randomSpawn(rng);
+		// Runs of particles that die in the same step, including at the end of the buffer.
+		spawn.lifetime = (id / 7) % 3 == 0 ? 0.1f : lifetime(rng);
+		spawn.startSize = spawn.endSize = static_cast<float>(id);
+		buffer.Add(spawn);
+		expectedLife.push_back(spawn.lifetime);
+	}
+
+	const float deltaTime = 1.0f / 60.0f;
+	for (int step = 0; buffer.count > 0; step++) {
+		buffer.Update(deltaTime);
+		std::vector<int> expected;
+		for (size_t id = 0; id < numParticles; id++) {
+			expectedLife[id] -= deltaTime;
+			if (expectedLife[id] > 0.0f) {
+				expected.push_back(static_cast<int>(id));
+			}
+		}
+
+		std::vector<int> alive;
+		for (size_t i = 0; i < buffer.count; i++) {
+			if (buffer.life[i] <= 0.0f) {
+				printf("FAIL dead particle %d left at %zu after step %d\n", static_cast<int>(buffer.size[i]), i, step);
+				return false;
+			}
+			alive.push_back(static_cast<int>(buffer.size[i]));
+		}
+		std::sort(alive.begin(), alive.end());
+		if (alive != expected) {
+			printf("FAIL %zu particles alive after step %d, expected %zu\n", alive.size(), step, expected.size());
+			return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	std::mt19937 rng(48);
+	for (size_t numParticles = 0; numParticles <= 67; numParticles++) {
+		if (!kernelsMatch(rng, numParticles)) {
+			return 1;
+		}
+	}
+	if (!kernelsMatch(rng, 10001) || !paddingLanes(rng)) {
+		return 1;
+	}
+	for (size_t numParticles: {1, 2, 3, 4, 5, 13, 100, 1001}) {
+		if (!swapAndPop(rng, numParticles)) {
+			return 1;
+		}
+	}
+#ifdef __SSE2__
+	printf("ParticleKernelTest passed (sse2 tested)\n");
+#else
+	printf("ParticleKernelTest passed (sse2 not available, scalar only)\n");
+#endif
+	return 0;
+}
@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <thread>
+#include <memory>
+#include "../src/Systems/RenderSystem.h"
+
+// Steps the same scene of moving sprites through RenderSystem::Extract with 1 thread, then 2, 4, ... up to the
+// hardware thread count, and reports the time per frame against the single threaded run. Some sprites change z or
+// texture every frame. Every run must extract exactly the same quads every frame.
+
+// Sprites are given their texture regions directly, so Extract never asks the AssetStore for one. This only stands
+// in for the AssetStore's lookup so the bench links without SDL.
+const TextureRegion *AssetStore::GetTextureRegion(const std::string &) const {
+	return nullptr;
+}
+
+// No AssetStore is ever made. The empty pointer Extract takes is never destroyed, which would need the AssetStore's
+// destructor and with it SDL.
+static std::unique_ptr<AssetStore> &noAssetStore = *new std::unique_ptr<AssetStore>();
+
+static const int NUM_SPRITES = 50000;
+static const int NUM_FRAMES = 60;
+static const int NUM_REGIONS = 8;
+static const int NUM_LAYERS = 3;
+static const float WORLD_SIZE = 8000.0f;
+
+// FNV-1a over the extracted vertices and runs, one per frame, so runs can be compared without keeping every frame.
+static uint64_t checksum(const SpriteVertexBuffer &sprites) {
+	uint64_t hash = 14695981039346656037ull;
+	auto add = [&hash](const void *data, size_t size) {
+		const unsigned char *bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++) {
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		}
+	};
+	add(sprites.vertices.data(), sprites.vertices.size() * sizeof(SDL_Vertex));
+	for (const auto &run: sprites.runs) {
+		add(&run.zIndex, sizeof(run.zIndex));
+		add(&run.texture, sizeof(run.texture));
+		add(&run.firstVertex, sizeof(run.firstVertex));
+		add(&run.numVertices, sizeof(run.numVertices));
+	}
+	return hash;
+}
+
+static double runScene(size_t numThreads, const TextureRegion *regions, std::vector<uint64_t> &checksums, size_t &numQuads) {
+	EntityManager entityManager;
+	entityManager.AddSystem<RenderSystem>();
+	entityManager.AddSystem<VisibilitySystem>();
+	auto threadPool = std::make_unique<ThreadPool>(numThreads);
+
+	std::mt19937 rng(50);
+	std::uniform_real_distribution<float> position(0.0f, WORLD_SIZE);
+	std::uniform_real_distribution<float> step(-4.0f, 4.0f);
+	std::vector<Entity> entities;
+	for (int i = 0; i < NUM_SPRITES; i++) {
+		Entity entity = entityManager.CreateEntity();
+		entity.AddComponent<TransformComponent>(glm::vec2(position(rng), position(rng)), glm::vec2(1, 1), i % 4 == 0 ? static_cast<double>(rng() % 360) : 0.0);
+		entity.AddComponent<SpriteComponent>("sprite", 32, 32, static_cast<int>(rng() % NUM_LAYERS));
+		entity.AddComponent<RigidBodyComponent>();
+		entity.GetComponent<SpriteComponent>().texture = &regions[rng() % NUM_REGIONS];
+		entities.push_back(entity);
+	}
+	entityManager.Update();
+
+	auto &visibility = entityManager.GetSystem<VisibilitySystem>();
+	auto &renderSystem = entityManager.GetSystem<RenderSystem>();
+	RenderSnapshot snapshot;
+	double milliseconds = 0;
+	numQuads = 0;
+	for (int frame = 0; frame < NUM_FRAMES; frame++) {
+		for (auto entity: entities) {
+			auto &transform = entity.GetComponent<TransformComponent>();
+			transform.previousPosition = transform.position;
+			transform.position += glm::vec2(step(rng), step(rng));
+		}
+		for (int i = 0; i < 100; i++) {
+			auto &sprite = entities[rng() % entities.size()].GetComponent<SpriteComponent>();
+			sprite.zIndex = static_cast<int>(rng() % NUM_LAYERS);
+			sprite.texture = &regions[rng() % NUM_REGIONS];
+		}
+
+		snapshot.Clear();
+		snapshot.alpha = 0.5f;
+		snapshot.previousCamera = {frame * 10, frame * 10, 4000, 4000};
+		snapshot.camera = {frame * 10 + 10, frame * 10 + 10, 4000, 4000};
+		visibility.Update({snapshot.previousCamera.x, snapshot.previousCamera.y, 4010, 4010});
+
+		const auto start = std::chrono::steady_clock::now();
+		renderSystem.Extract(snapshot, noAssetStore, visibility, threadPool);
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		milliseconds += elapsed.count();
+		checksums.push_back(checksum(snapshot.sprites));
+		numQuads += snapshot.sprites.NumSprites();
+	}
+	return milliseconds / NUM_FRAMES;
+}
+
+int main() {
+	const size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+	TextureRegion regions[NUM_REGIONS];
+	for (int i = 0; i < NUM_REGIONS; i++) {
+		SDL_Texture *texture = reinterpret_cast<SDL_Texture*>(static_cast<uintptr_t>(0x1000 + 0x100 * (i % 4)));
+		regions[i] = {texture, {i * 32, 0, 32, 32}, 512, 512};
+	}
+
+	std::vector<uint64_t> expected;
+	size_t numQuads = 0;
+	const double baseline = runScene(1, regions, expected, numQuads);
+	printf("%d sprites, %zu quads extracted over %d frames\n", NUM_SPRITES, numQuads, NUM_FRAMES);
+	printf("%8s %12s %10s\n", "threads", "ms/frame", "speedup");
+	printf("%8d %12.3f %10.2f\n", 1, baseline, 1.0);
+
+	std::vector<size_t> threadCounts;
+	for (size_t numThreads = 2; numThreads < maxThreads; numThreads *= 2) {
+		threadCounts.push_back(numThreads);
+	}
+	if (maxThreads > 1) {
+		threadCounts.push_back(maxThreads);
+	}
+
+	for (size_t numThreads: threadCounts) {
+		std::vector<uint64_t> checksums;
+		const double milliseconds = runScene(numThreads, regions, checksums, numQuads);
+		if (checksums != expected) {
+			printf("FAIL %zu threads extracted different quads than 1 thread\n", numThreads);
+			return 1;
+		}
+		printf("%8zu %12.3f %10.2f\n", numThreads, milliseconds, baseline / milliseconds);
+	}
+	return 0;
+}
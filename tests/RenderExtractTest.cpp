@@ -0,0 +1,161 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <memory>
+#include "../src/Systems/RenderSystem.h"
+
+// Builds the same scene of sprites once for each of 1, 2, 4 and 8 extract threads and steps them all through the
+// same frames, moving sprites, panning the camera and changing the z index or texture of some sprites every frame.
+// Every frame the sprite quads extracted with more threads must be byte for byte the ones extracted with one
+// thread. The one thread output must also hold a quad for every visible sprite, in z and texture order.
+
+// Sprites are given their texture regions directly, so Extract never asks the AssetStore for one. This only stands
+// in for the AssetStore's lookup so the test links without SDL.
+const TextureRegion *AssetStore::GetTextureRegion(const std::string &) const {
+	return nullptr;
+}
+
+// No AssetStore is ever made. The empty pointer Extract takes is never destroyed, which would need the AssetStore's
+// destructor and with it SDL.
+static std::unique_ptr<AssetStore> &noAssetStore = *new std::unique_ptr<AssetStore>();
+
+static const int NUM_SPRITES = 6000;
+static const int NUM_FRAMES = 40;
+static const int NUM_REGIONS = 6;
+static const int NUM_LAYERS = 4;
+static const int WORLD_SIZE = 4000;
+
+struct World {
+	std::unique_ptr<EntityManager> entityManager;
+	std::unique_ptr<ThreadPool> threadPool;
+	std::vector<Entity> entities;
+	RenderSnapshot snapshot;
+
+	World(size_t numThreads, const TextureRegion *regions): entityManager(std::make_unique<EntityManager>()), threadPool(std::make_unique<ThreadPool>(numThreads)) {
+		entityManager->AddSystem<RenderSystem>();
+		entityManager->AddSystem<VisibilitySystem>();
+		std::mt19937 rng(50);
+		for (int i = 0; i < NUM_SPRITES; i++) {
+			Entity entity = entityManager->CreateEntity();
+			const glm::vec2 position(rng() % WORLD_SIZE, rng() % WORLD_SIZE);
+			entity.AddComponent<TransformComponent>(position, glm::vec2(1 + i % 2, 1), i % 7 == 0 ? static_cast<double>(rng() % 360) : 0.0);
+			entity.AddComponent<SpriteComponent>("sprite", 32, 32, rng() % NUM_LAYERS, i % 1000 == 0);
+			if (i % 5 == 0) {
+				entity.AddComponent<RigidBodyComponent>(glm::vec2(1, 2));
+			}
+			auto &sprite = entity.GetComponent<SpriteComponent>();
+			sprite.texture = &regions[rng() % NUM_REGIONS];
+			sprite.srcRect.x = (i % 3) * 32;
+			if (i % 11 == 0) {
+				sprite.isFlipped = static_cast<SDL_RendererFlip>(i % 3);
+			}
+			entities.push_back(entity);
+		}
+		entityManager->Update();
+	}
+
+	// Every world gets the same changes for a frame from the same seed.
+	void step(int frame, const TextureRegion *regions) {
+		for (size_t i = 0; i < entities.size(); i += 5) {
+			auto &transform = entities[i].GetComponent<TransformComponent>();
+			transform.previousPosition = transform.position;
+			transform.previousRotation = transform.rotation;
+			transform.position += glm::vec2(3, -2);
+			transform.rotation += 5;
+		}
+		std::mt19937 rng(frame);
+		for (int i = 0; i < 60; i++) {
+			auto &sprite = entities[rng() % entities.size()].GetComponent<SpriteComponent>();
+			if (i % 2 == 0) {
+				sprite.zIndex = rng() % NUM_LAYERS;
+			} else {
+				sprite.texture = &regions[rng() % NUM_REGIONS];
+			}
+		}
+
+		snapshot.Clear();
+		snapshot.alpha = (frame % 4) * 0.25f + 0.1f;
+		snapshot.previousCamera = {frame * 7, frame * 3, 3000, 3000};
+		snapshot.camera = {(frame + 1) * 7, (frame + 1) * 3, 3000, 3000};
+		SDL_Rect view = snapshot.camera;
+		view.x = std::min(snapshot.previousCamera.x, snapshot.camera.x);
+		view.y = std::min(snapshot.previousCamera.y, snapshot.camera.y);
+		view.w += std::abs(snapshot.camera.x - snapshot.previousCamera.x);
+		view.h += std::abs(snapshot.camera.y - snapshot.previousCamera.y);
+		auto &visibility = entityManager->GetSystem<VisibilitySystem>();
+		visibility.Update(view);
+		entityManager->GetSystem<RenderSystem>().Extract(snapshot, noAssetStore, visibility, threadPool);
+	}
+
+	size_t numVisible() const {
+		const auto &visibility = entityManager->GetSystem<VisibilitySystem>();
+		size_t count = 0;
+		for (auto entity: entities) {
+			count += visibility.IsVisible(entity) ? 1 : 0;
+		}
+		return count;
+	}
+};
+
+static bool sameRuns(const std::vector<SpriteRun> &a, const std::vector<SpriteRun> &b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a[i].zIndex != b[i].zIndex || a[i].texture != b[i].texture || a[i].firstVertex != b[i].firstVertex || a[i].numVertices != b[i].numVertices) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	// Two regions share each texture, so texture changes sometimes keep the bucket and sometimes don't.
+	TextureRegion regions[NUM_REGIONS];
+	for (int i = 0; i < NUM_REGIONS; i++) {
+		SDL_Texture *texture = reinterpret_cast<SDL_Texture*>(static_cast<uintptr_t>(0x1000 + 0x100 * (i % 3)));
+		regions[i] = {texture, {i * 40, i * 8, 32, 32}, 256 + 64 * (i % 3), 512};
+	}
+
+	const size_t threadCounts[] = {1, 2, 4, 8};
+	std::vector<std::unique_ptr<World>> worlds;
+	for (size_t numThreads: threadCounts) {
+		worlds.push_back(std::make_unique<World>(numThreads, regions));
+	}
+
+	size_t numQuads = 0;
+	for (int frame = 0; frame < NUM_FRAMES; frame++) {
+		for (auto &world: worlds) {
+			world->step(frame, regions);
+		}
+
+		const SpriteVertexBuffer &expected = worlds[0]->snapshot.sprites;
+		if (expected.NumSprites() != worlds[0]->numVisible()) {
+			printf("FAIL frame %d: %zu quads for %zu visible sprites\n", frame, expected.NumSprites(), worlds[0]->numVisible());
+			return 1;
+		}
+		for (size_t i = 1; i < expected.runs.size(); i++) {
+			if (!expected.runs[i - 1].DrawsBefore(expected.runs[i])) {
+				printf("FAIL frame %d: run %zu is out of z and texture order\n", frame, i);
+				return 1;
+			}
+		}
+
+		for (size_t i = 1; i < worlds.size(); i++) {
+			const SpriteVertexBuffer &sprites = worlds[i]->snapshot.sprites;
+			const bool isSame = sprites.vertices.size() == expected.vertices.size()
+				&& std::memcmp(sprites.vertices.data(), expected.vertices.data(), expected.vertices.size() * sizeof(SDL_Vertex)) == 0
+				&& sameRuns(sprites.runs, expected.runs);
+			if (!isSame) {
+				printf("FAIL frame %d: %zu threads extracted %zu quads in %zu runs, 1 thread %zu quads in %zu runs\n", frame, threadCounts[i],
+					sprites.NumSprites(), sprites.runs.size(), expected.NumSprites(), expected.runs.size());
+				return 1;
+			}
+		}
+		numQuads += expected.NumSprites();
+	}
+	printf("RenderExtractTest passed: %zu quads over %d frames\n", numQuads, NUM_FRAMES);
+	return 0;
+}
@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "../src/AssetStore/SkylinePacker.h"
+#include "../src/AssetStore/AssetStore.h"
+
+// Packs random images into atlas pages the way AssetStore::BuildAtlas does, with ATLAS_PADDING added to each, and
+// checks that the padded rects stay inside the page and never overlap. Also checks that Insert returns false for
+// rects that don't fit, and that a packer which refused a rect still packs later ones.
+
+static const int PAGE_SIZE = AssetStore::MAX_ATLAS_PAGE_SIZE;
+static const int PADDING = AssetStore::ATLAS_PADDING;
+
+static bool overlaps(const SDL_Rect &a, const SDL_Rect &b) {
+	return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+struct Page {
+	SkylinePacker packer;
+	std::vector<SDL_Rect> rects;
+
+	Page(): packer(PAGE_SIZE, PAGE_SIZE) {}
+};
+
+// Checks a rect the packer has just placed against the page and everything packed before it.
+static bool checkRect(const Page &page, const SDL_Rect &rect) {
+	if (rect.x < 0 || rect.y < 0 || rect.x + rect.w > PAGE_SIZE || rect.y + rect.h > PAGE_SIZE) {
+		printf("FAIL %dx%d at (%d, %d) is outside the %dx%d page\n", rect.w, rect.h, rect.x, rect.y, PAGE_SIZE, PAGE_SIZE);
+		return false;
+	}
+	for (const auto &other: page.rects) {
+		if (overlaps(rect, other)) {
+			printf("FAIL %dx%d at (%d, %d) overlaps %dx%d at (%d, %d)\n", rect.w, rect.h, rect.x, rect.y, other.w, other.h, other.x, other.y);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Random images, tallest first as BuildAtlas sorts them, or in the order they come.
+static bool randomPages(unsigned seed, bool isSorted, size_t &numRects) {
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> size(1, seed % 2 == 0 ? 64 : 400);
+	std::vector<std::pair<int, int>> images;
+	for (int i = 0; i < 1500; i++) {
+		images.push_back({size(rng), size(rng)});
+	}
+	if (isSorted) {
+		std::stable_sort(images.begin(), images.end(), [](const auto &a, const auto &b) {
+			return a.second != b.second ? a.second > b.second : a.first > b.first;
+		});
+	}
+
+	std::vector<Page> pages;
+	for (const auto &image: images) {
+		const int width = image.first + PADDING;
+		const int height = image.second + PADDING;
+		SDL_Point position;
+		size_t page = 0;
+		while (page < pages.size() && !pages[page].packer.Insert(width, height, position)) {
+			page++;
+		}
+		if (page == pages.size()) {
+			pages.emplace_back();
+			if (!pages.back().packer.Insert(width, height, position)) {
+				printf("FAIL %dx%d doesn't fit an empty page\n", width, height);
+				return false;
+			}
+		}
+		const SDL_Rect rect = {position.x, position.y, width, height};
+		if (!checkRect(pages[page], rect)) {
+			return false;
+		}
+		pages[page].rects.push_back(rect);
+		numRects++;
+	}
+	return true;
+}
+
+static bool expectInsert(SkylinePacker &packer, int width, int height, bool isExpected, SDL_Point expected = {0, 0}) {
+	SDL_Point position = {-1, -1};
+	const bool isInserted = packer.Insert(width, height, position);
+	if (isInserted != isExpected) {
+		printf("FAIL inserting %dx%d returned %s\n", width, height, isInserted ? "true" : "false");
+		return false;
+	}
+	if (isInserted && (position.x != expected.x || position.y != expected.y)) {
+		printf("FAIL %dx%d went to (%d, %d), expected (%d, %d)\n", width, height, position.x, position.y, expected.x, expected.y);
+		return false;
+	}
+	return true;
+}
+
+static bool rectsThatDontFit() {
+	SkylinePacker packer(100, 100);
+	if (!expectInsert(packer, 101, 10, false) || !expectInsert(packer, 10, 101, false) || !expectInsert(packer, 101, 101, false)) {
+		return false;
+	}
+	// A full height column leaves a 40 wide gap, which narrower rects still go into.
+	if (!expectInsert(packer, 60, 100, true, {0, 0}) || !expectInsert(packer, 50, 10, false) || !expectInsert(packer, 40, 101, false)) {
+		return false;
+	}
+	if (!expectInsert(packer, 40, 70, true, {60, 0}) || !expectInsert(packer, 40, 31, false) || !expectInsert(packer, 41, 30, false)) {
+		return false;
+	}
+	if (!expectInsert(packer, 40, 30, true, {60, 70}) || !expectInsert(packer, 1, 1, false)) {
+		return false;
+	}
+
+	// A page tiled exactly with padded images has no room left at all.
+	const int tile = 62 + PADDING;
+	SkylinePacker tiled(PAGE_SIZE, PAGE_SIZE);
+	for (int y = 0; y < PAGE_SIZE; y += tile) {
+		for (int x = 0; x < PAGE_SIZE; x += tile) {
+			if (!expectInsert(tiled, tile, tile, true, {x, y})) {
+				return false;
+			}
+		}
+	}
+	return expectInsert(tiled, 1, 1, false);
+}
+
+int main() {
+	if (!rectsThatDontFit()) {
+		return 1;
+	}
+	size_t numRects = 0;
+	for (unsigned seed = 0; seed < 8; seed++) {
+		if (!randomPages(seed, seed < 4, numRects)) {
+			return 1;
+		}
+	}
+	printf("SkylinePackerTest passed: %zu rects\n", numRects);
+	return 0;
+}
@@ -0,0 +1,165 @@
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "../src/Collision/SpatialQuery.h"
+
+// Checks the spatial queries against brute force passes over every box, on random scenes binned into grids of
+// several cell sizes. Rays are also cast along cell boundaries and through grid corners, and Nearest is asked for
+// more entities than there are.
+
+static const float INF = std::numeric_limits<float>::infinity();
+
+// Same test as the query's, so that the comparison is about which boxes the grid walk reaches.
+static float bruteForceRaycast(const AABBArray &boxes, glm::vec2 origin, glm::vec2 direction, float maxDistance) {
+	direction /= std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	const glm::vec2 invDirection(direction.x != 0 ? 1.0f / direction.x : INF, direction.y != 0 ? 1.0f / direction.y : INF);
+	float best = INF;
+	for (size_t i = 0; i < boxes.Size(); i++) {
+		const AABB box = boxes.Get(i);
+		const float tx1 = (box.minX - origin.x) * invDirection.x;
+		const float tx2 = (box.maxX - origin.x) * invDirection.x;
+		const float ty1 = (box.minY - origin.y) * invDirection.y;
+		const float ty2 = (box.maxY - origin.y) * invDirection.y;
+		const float tEnter = std::max(std::min(tx1, tx2), std::min(ty1, ty2));
+		const float tExit = std::min(std::max(tx1, tx2), std::max(ty1, ty2));
+		if (tExit < 0 || tEnter > tExit || tEnter > maxDistance) {
+			continue;
+		}
+		best = std::min(best, std::max(tEnter, 0.0f));
+	}
+	return best;
+}
+
+static std::vector<int> ids(const std::vector<Entity> &entities, bool isSorted) {
+	std::vector<int> result;
+	for (auto entity: entities) {
+		result.push_back(entity.GetId());
+	}
+	if (isSorted) {
+		std::sort(result.begin(), result.end());
+	}
+	return result;
+}
+
+struct Checker {
+	const AABBArray &boxes;
+	SpatialQuery &query;
+	size_t numFailures = 0;
+
+	void raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance) {
+		RaycastHit hit;
+		const bool isHit = query.Raycast(origin, direction, maxDistance, hit);
+		const float expected = bruteForceRaycast(boxes, origin, direction, maxDistance);
+		if (isHit != (expected != INF) || (isHit && std::fabs(hit.distance - expected) > 1e-3f)) {
+			printf("FAIL raycast from (%f, %f) along (%f, %f): %s %f, expected %f\n", origin.x, origin.y, direction.x, direction.y, isHit ? "hit at" : "missed", isHit ? hit.distance : 0.0f, expected);
+			numFailures++;
+		}
+	}
+
+	void nearest(glm::vec2 point, size_t k) {
+		std::vector<std::pair<float, int>> distances;
+		for (size_t i = 0; i < boxes.Size(); i++) {
+			const AABB box = boxes.Get(i);
+			const glm::vec2 delta = glm::vec2((box.minX + box.maxX) / 2, (box.minY + box.maxY) / 2) - point;
+			distances.push_back({delta.x * delta.x + delta.y * delta.y, static_cast<int>(i)});
+		}
+		std::sort(distances.begin(), distances.end());
+		std::vector<int> expected;
+		for (size_t i = 0; i < std::min(k, distances.size()); i++) {
+			expected.push_back(distances[i].second);
+		}
+		if (ids(query.Nearest(point, k), false) != expected) {
+			printf("FAIL nearest %zu to (%f, %f) among %zu boxes\n", k, point.x, point.y, boxes.Size());
+			numFailures++;
+		}
+	}
+
+	void area(const AABB &area, float radius) {
+		std::vector<int> overlapping, inRadius;
+		const glm::vec2 centre(area.minX, area.minY);
+		for (size_t i = 0; i < boxes.Size(); i++) {
+			const AABB box = boxes.Get(i);
+			if (AABBOverlaps(area, box)) {
+				overlapping.push_back(static_cast<int>(i));
+			}
+			const float dx = std::max(std::max(box.minX - centre.x, 0.0f), centre.x - box.maxX);
+			const float dy = std::max(std::max(box.minY - centre.y, 0.0f), centre.y - box.maxY);
+			if (dx * dx + dy * dy <= radius * radius) {
+				inRadius.push_back(static_cast<int>(i));
+			}
+		}
+		if (ids(query.QueryAABB(area), true) != overlapping) {
+			printf("FAIL QueryAABB (%f, %f, %f, %f)\n", area.minX, area.minY, area.maxX, area.maxY);
+			numFailures++;
+		}
+		if (ids(query.QueryRadius(centre, radius), true) != inRadius) {
+			printf("FAIL QueryRadius (%f, %f) %f\n", centre.x, centre.y, radius);
+			numFailures++;
+		}
+	}
+};
+
+int main() {
+	std::mt19937 rng(30);
+	std::uniform_real_distribution<float> position(-500.0f, 3000.0f);
+	std::uniform_real_distribution<float> size(2.0f, 80.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+	size_t numChecks = 0;
+	size_t numFailures = 0;
+
+	for (int scene = 0; scene < 60; scene++) {
+		AABBArray boxes;
+		std::vector<Entity> entities;
+		const int numBoxes = 1 + scene * 15;
+		for (int i = 0; i < numBoxes; i++) {
+			const float x = position(rng), y = position(rng);
+			boxes.Add({x, y, x + size(rng), y + size(rng)});
+			entities.push_back(Entity(i));
+		}
+		Broadphase broadphase(scene % 3 == 0 ? 32.0f : scene % 3 == 1 ? 64.0f : 200.0f);
+		broadphase.Build(boxes);
+		SpatialQuery query(broadphase, boxes, entities);
+		Checker checker = {boxes, query};
+
+		const AABB bounds = broadphase.GetBounds();
+		const float cellWidth = broadphase.GetCellWidth();
+		const float cellHeight = broadphase.GetCellHeight();
+
+		for (int i = 0; i < 40; i++) {
+			const glm::vec2 point(position(rng), position(rng));
+			const float extent = size(rng) * 4;
+			checker.area({point.x, point.y, point.x + extent, point.y + extent * 0.5f}, extent);
+
+			const float theta = angle(rng);
+			checker.raycast(point, glm::vec2(std::cos(theta), std::sin(theta)), i % 4 == 0 ? 300.0f : 5000.0f);
+
+			// Along a vertical and a horizontal cell boundary, both ways, and diagonally through a grid corner.
+			const int col = static_cast<int>(rng() % broadphase.NumCols());
+			const int row = static_cast<int>(rng() % broadphase.NumRows());
+			const float edgeX = bounds.minX + col * cellWidth;
+			const float edgeY = bounds.minY + row * cellHeight;
+			checker.raycast(glm::vec2(edgeX, bounds.minY - 10), glm::vec2(0, 1), 5000.0f);
+			checker.raycast(glm::vec2(edgeX, bounds.maxY + 10), glm::vec2(0, -1), 5000.0f);
+			checker.raycast(glm::vec2(bounds.minX - 10, edgeY), glm::vec2(1, 0), 5000.0f);
+			checker.raycast(glm::vec2(bounds.maxX + 10, edgeY), glm::vec2(-1, 0), 5000.0f);
+			checker.raycast(glm::vec2(edgeX, edgeY), glm::vec2(cellWidth, cellHeight), 5000.0f);
+			checker.raycast(glm::vec2(edgeX, edgeY), glm::vec2(-cellWidth, cellHeight), 5000.0f);
+
+			checker.nearest(point, 1 + i % 7);
+			checker.nearest(glm::vec2(edgeX, edgeY), 3);
+			numChecks += 10;
+		}
+		checker.nearest(glm::vec2(position(rng), position(rng)), numBoxes + 5);
+		numFailures += checker.numFailures;
+	}
+
+	if (numFailures > 0) {
+		printf("SpatialQueryTest failed %zu of %zu checks\n", numFailures, numChecks);
+		return 1;
+	}
+	printf("SpatialQueryTest passed: %zu checks\n", numChecks);
+	return 0;
+}
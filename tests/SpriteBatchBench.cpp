@@ -0,0 +1,162 @@
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <SDL2/SDL.h>
+#include "../src/Renderer/SpriteBatcher.h"
+
+// Draws a scene of 20000 sprites with SDL's software renderer into a 1280x720 surface, the way headless runs do.
+// The old path is the original RenderSystem: sort by z index, then one SDL_RenderCopyEx per sprite. The new path
+// builds the sprites' quads into a SpriteVertexBuffer and submits it with SpriteBatcher. The scene is drawn once with
+// a texture per sprite kind, and once with every kind packed into one atlas page. Reports draw calls and the time
+// per frame of each path.
+
+static const int NUM_SPRITES = 20000;
+static const int NUM_KINDS = 8;
+static const int NUM_LAYERS = 3;
+static const int NUM_FRAMES = 20;
+static const int SCREEN_WIDTH = 1280;
+static const int SCREEN_HEIGHT = 720;
+static const int SPRITE_SIZE = 32;
+
+struct Sprite {
+	int kind;
+	int zIndex;
+	SDL_Rect srcRect;
+	SDL_FRect dstRect;
+	float rotation;
+	SDL_RendererFlip flip;
+};
+
+struct Result {
+	double milliseconds;
+	size_t numDrawCalls;
+};
+
+static SDL_Texture *createTexture(SDL_Renderer *renderer, int width, int height, std::mt19937 &rng) {
+	SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+	SDL_FillRect(surface, nullptr, rng());
+	SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+	SDL_FreeSurface(surface);
+	return texture;
+}
+
+static Result drawOld(SDL_Renderer *renderer, const std::vector<Sprite> &sprites, const std::vector<SDL_Texture*> &textures) {
+	std::vector<Sprite> sorted;
+	size_t numDrawCalls = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < NUM_FRAMES; frame++) {
+		SDL_RenderClear(renderer);
+		sorted = sprites;
+		std::sort(sorted.begin(), sorted.end(), [](const Sprite &a, const Sprite &b) {
+			return a.zIndex < b.zIndex;
+		});
+		numDrawCalls = 0;
+		for (const auto &sprite: sorted) {
+			const SDL_Rect dstRect = {
+				static_cast<int>(sprite.dstRect.x),
+				static_cast<int>(sprite.dstRect.y),
+				static_cast<int>(sprite.dstRect.w),
+				static_cast<int>(sprite.dstRect.h)
+			};
+			SDL_RenderCopyEx(renderer, textures[sprite.kind % textures.size()], &sprite.srcRect, &dstRect, sprite.rotation, NULL, sprite.flip);
+			numDrawCalls++;
+		}
+		SDL_RenderPresent(renderer);
+	}
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return {elapsed.count() / NUM_FRAMES, numDrawCalls};
+}
+
+// Builds the buffer the way RenderSystem's snapshot does: sprites are bucketed by z index and texture first, so
+// each bucket becomes one run.
+static Result drawNew(SDL_Renderer *renderer, const std::vector<Sprite> &sprites, const std::vector<SDL_Texture*> &textures, float textureWidth, float textureHeight) {
+	SpriteVertexBuffer buffer;
+	SpriteBatcher batcher;
+	std::vector<const Sprite*> sorted;
+	const auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < NUM_FRAMES; frame++) {
+		SDL_RenderClear(renderer);
+		sorted.clear();
+		for (const auto &sprite: sprites) {
+			sorted.push_back(&sprite);
+		}
+		std::stable_sort(sorted.begin(), sorted.end(), [&textures](const Sprite *a, const Sprite *b) {
+			const SpriteRun runA = {a->zIndex, textures[a->kind % textures.size()], 0, 0};
+			const SpriteRun runB = {b->zIndex, textures[b->kind % textures.size()], 0, 0};
+			return runA.DrawsBefore(runB);
+		});
+		buffer.Clear();
+		for (const Sprite *sprite: sorted) {
+			buffer.AddQuad(textures[sprite->kind % textures.size()], sprite->zIndex, textureWidth, textureHeight, sprite->srcRect, sprite->dstRect, sprite->rotation, sprite->flip);
+		}
+		batcher.Draw(renderer, buffer);
+		SDL_RenderPresent(renderer);
+	}
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return {elapsed.count() / NUM_FRAMES, batcher.GetStats().numDrawCalls};
+}
+
+int main() {
+	if (SDL_Init(0) != 0) {
+		printf("FAIL SDL_Init: %s\n", SDL_GetError());
+		return 1;
+	}
+	SDL_Surface *screen = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+	SDL_Renderer *renderer = screen ? SDL_CreateSoftwareRenderer(screen) : nullptr;
+	if (!renderer) {
+		printf("FAIL creating the software renderer: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	std::mt19937 rng(37);
+	std::vector<SDL_Texture*> textures;
+	for (int kind = 0; kind < NUM_KINDS; kind++) {
+		textures.push_back(createTexture(renderer, SPRITE_SIZE * 2, SPRITE_SIZE, rng));
+	}
+	// Every kind's two frames side by side on one page, as the atlas packs them.
+	std::vector<SDL_Texture*> atlas = {createTexture(renderer, SPRITE_SIZE * 2 * NUM_KINDS, SPRITE_SIZE, rng)};
+
+	std::uniform_real_distribution<float> x(-SPRITE_SIZE, SCREEN_WIDTH);
+	std::uniform_real_distribution<float> y(-SPRITE_SIZE, SCREEN_HEIGHT);
+	std::vector<Sprite> sprites, atlasSprites;
+	for (int i = 0; i < NUM_SPRITES; i++) {
+		Sprite sprite;
+		sprite.kind = rng() % NUM_KINDS;
+		sprite.zIndex = rng() % NUM_LAYERS;
+		sprite.srcRect = {static_cast<int>(rng() % 2) * SPRITE_SIZE, 0, SPRITE_SIZE, SPRITE_SIZE};
+		sprite.dstRect = {x(rng), y(rng), SPRITE_SIZE, SPRITE_SIZE};
+		sprite.rotation = i % 10 == 0 ? static_cast<float>(rng() % 360) : 0.0f;
+		sprite.flip = i % 7 == 0 ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE;
+		sprites.push_back(sprite);
+
+		sprite.srcRect.x += sprite.kind * SPRITE_SIZE * 2;
+		atlasSprites.push_back(sprite);
+	}
+
+	// One untimed frame of each, so texture setup isn't counted.
+	drawOld(renderer, sprites, textures);
+	drawNew(renderer, sprites, textures, SPRITE_SIZE * 2, SPRITE_SIZE);
+
+	const Result oldTextures = drawOld(renderer, sprites, textures);
+	const Result newTextures = drawNew(renderer, sprites, textures, SPRITE_SIZE * 2, SPRITE_SIZE);
+	const Result oldAtlas = drawOld(renderer, atlasSprites, atlas);
+	const Result newAtlas = drawNew(renderer, atlasSprites, atlas, SPRITE_SIZE * 2 * NUM_KINDS, SPRITE_SIZE);
+
+	printf("%d sprites, %d kinds, %d z layers, %dx%d software renderer\n", NUM_SPRITES, NUM_KINDS, NUM_LAYERS, SCREEN_WIDTH, SCREEN_HEIGHT);
+	printf("%10s %6s %12s %12s\n", "textures", "path", "draw calls", "ms/frame");
+	printf("%10s %6s %12zu %12.3f\n", "separate", "old", oldTextures.numDrawCalls, oldTextures.milliseconds);
+	printf("%10s %6s %12zu %12.3f\n", "separate", "new", newTextures.numDrawCalls, newTextures.milliseconds);
+	printf("%10s %6s %12zu %12.3f\n", "atlas", "old", oldAtlas.numDrawCalls, oldAtlas.milliseconds);
+	printf("%10s %6s %12zu %12.3f\n", "atlas", "new", newAtlas.numDrawCalls, newAtlas.milliseconds);
+
+	for (auto texture: textures) {
+		SDL_DestroyTexture(texture);
+	}
+	SDL_DestroyTexture(atlas[0]);
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(screen);
+	SDL_Quit();
+	return 0;
+}